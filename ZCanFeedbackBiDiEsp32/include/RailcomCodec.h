@@ -0,0 +1,111 @@
+/*********************************************************************
+ * Railcom Codec
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 4 of 8 code of railcom, decoding table is generated from encoding table at compile time and placed in flash
+// Every project of this repository is a standalone PlatformIO / STM32Cube project without a common include path,
+// so this header is copied byte identical into each of them (Railcom/Codec.h of the STM32 Arduino projects,
+// RailcomCodec.h of the ESP32 and Cube projects). Change all copies together, every build of ZCanFeedbackBiDiSTM32FreeRtos
+// checks them by scripts/check_codec_copies.py.
+namespace RailcomCodec
+{
+    // code of values 0x00 up to 0x3F, NACK, ACK, BUSY and three codes which are not used
+    constexpr uint8_t encode4to8[]{
+        0b10101100, 0b10101010, 0b10101001, 0b10100101, 0b10100011, 0b10100110, 0b10011100, 0b10011010, // 0x00
+        0b10011001, 0b10010101, 0b10010011, 0b10010110, 0b10001110, 0b10001101, 0b10001011, 0b10110001, // 0x08
+        0b10110010, 0b10110100, 0b10111000, 0b01110100, 0b01110010, 0b01101100, 0b01101010, 0b01101001, // 0x10
+        0b01100101, 0b01100011, 0b01100110, 0b01011100, 0b01011010, 0b01011001, 0b01010101, 0b01010011, // 0x18
+        0b01010110, 0b01001110, 0b01001101, 0b01001011, 0b01000111, 0b01110001, 0b11101000, 0b11100100, // 0x20
+        0b11100010, 0b11010001, 0b11001001, 0b11000101, 0b11011000, 0b11010100, 0b11010010, 0b11001010, // 0x28
+        0b11000110, 0b11001100, 0b01111000, 0b00010111, 0b00011011, 0b00011101, 0b00011110, 0b00101110, // 0x30
+        0b00110110, 0b00111010, 0b00100111, 0b00101011, 0b00101101, 0b00110101, 0b00111001, 0b00110011, // 0x38
+        0b00001111, // NACK
+        0b11110000, // ACK
+        0b11100001, // BUSY
+        0b11000011, // not used
+        0b10000111, // not used
+        0b00111100  // not used
+    };
+
+    constexpr uint8_t nack{0x40};
+    constexpr uint8_t ack{0x41};
+    constexpr uint8_t busy{0x42};
+    // decoded value of codes which are not used
+    constexpr uint8_t unused{0xEE};
+    // decoded value of bytes which are no 4 of 8 code
+    constexpr uint8_t invalid{0xFF};
+
+    constexpr std::size_t numberOfCodes{sizeof(encode4to8)};
+
+    // functions are recursive, so that they are usable with c++11
+    constexpr std::size_t indexOf(uint8_t code, std::size_t index = 0)
+    {
+        return ((numberOfCodes == index) || (code == encode4to8[index])) ? index : indexOf(code, index + 1);
+    }
+
+    constexpr uint8_t valueOf(std::size_t index)
+    {
+        return (numberOfCodes == index) ? invalid : ((index <= busy) ? static_cast<uint8_t>(index) : unused);
+    }
+
+    constexpr uint8_t decode(uint8_t code)
+    {
+        return valueOf(indexOf(code));
+    }
+
+    constexpr uint8_t numberOfOnes(uint8_t code)
+    {
+        return (0 == code) ? 0 : static_cast<uint8_t>((code & 1) + numberOfOnes(code >> 1));
+    }
+
+    constexpr bool hasFourOnes(std::size_t index = 0)
+    {
+        return (numberOfCodes == index) || ((4 == numberOfOnes(encode4to8[index])) && hasFourOnes(index + 1));
+    }
+
+    // no code is used twice
+    constexpr bool isUnique(std::size_t index = 0)
+    {
+        return (numberOfCodes == index) || ((index == indexOf(encode4to8[index])) && isUnique(index + 1));
+    }
+
+    static_assert(70 == numberOfCodes, "every byte with 4 of 8 bits set is a code");
+    static_assert(hasFourOnes(), "every code has 4 of 8 bits set");
+    static_assert(isUnique(), "encoding is not unique");
+
+#define RAILCOM_DECODE4(code) decode(code), decode(code + 1), decode(code + 2), decode(code + 3)
+#define RAILCOM_DECODE16(code) RAILCOM_DECODE4(code), RAILCOM_DECODE4(code + 4), RAILCOM_DECODE4(code + 8), RAILCOM_DECODE4(code + 12)
+#define RAILCOM_DECODE64(code) RAILCOM_DECODE16(code), RAILCOM_DECODE16(code + 16), RAILCOM_DECODE16(code + 32), RAILCOM_DECODE16(code + 48)
+
+    // value of received byte, unused or invalid
+    constexpr uint8_t encode8to4[256]{RAILCOM_DECODE64(0), RAILCOM_DECODE64(64), RAILCOM_DECODE64(128), RAILCOM_DECODE64(192)};
+
+#undef RAILCOM_DECODE4
+#undef RAILCOM_DECODE16
+#undef RAILCOM_DECODE64
+
+    static_assert((nack == encode8to4[0b00001111]) && (ack == encode8to4[0b11110000]) && (busy == encode8to4[0b11100001]),
+                  "decoding table does not match encoding table");
+    // neighbours of ACK are no 4 of 8 code, last entry exists
+    static_assert((invalid == encode8to4[0b11101111]) && (invalid == encode8to4[0b11110001]) && (invalid == encode8to4[0b11111111]),
+                  "decoding table is shifted");
+    static_assert((unused == encode8to4[0b11000011]) && (unused == encode8to4[0b10000111]) && (unused == encode8to4[0b00111100]),
+                  "unused codes are not marked");
+}
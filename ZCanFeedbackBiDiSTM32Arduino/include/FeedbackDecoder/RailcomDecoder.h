@@ -20,6 +20,7 @@
 #include <array>
 #include "FeedbackDecoder/FeedbackDecoder.h"
 #include "FeedbackDecoder/Railcom/Packet.h"
+#include "FeedbackDecoder/Railcom/Codec.h"
 
 class RailcomDecoder : public FeedbackDecoder
 {
@@ -168,6 +169,4 @@ protected:
 
     uint16_t m_channel2Direction{0};
 
-    static uint8_t encode4to8[];
-    static uint8_t encode8to4[];
 };
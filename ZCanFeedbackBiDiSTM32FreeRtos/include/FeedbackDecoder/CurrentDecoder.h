@@ -23,7 +23,7 @@
 class CurrentDecoder : public FeedbackDecoder
 {
 public:
-    CurrentDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+    CurrentDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                    int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...) = nullptr,
                    bool debug = false, bool zcanDebug = false, bool currentDebug = false);
     virtual ~CurrentDecoder() override;
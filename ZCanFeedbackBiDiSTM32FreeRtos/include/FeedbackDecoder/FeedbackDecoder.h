@@ -26,6 +26,10 @@ public:
     typedef struct
     {
         uint16_t trackSetCurrentINmA;
+        // occupied port becomes free below this current
+        uint16_t trackFreeCurrentINmA;
+        // weight of a new measurement in current of port is 1 / 2^trackFilterShift
+        uint16_t trackFilterShift;
         uint16_t trackFreeToSetTimeINms;
         uint16_t trackSetToFreeTimeINms;
     } TrackConfig;
@@ -35,12 +39,47 @@ public:
         uint16_t networkId;
         uint16_t modulAddress;
         uint16_t sendChannel2Data;
-        // std::array<TrackConfig, 8> trackConfig;
-        TrackConfig trackConfig;
+        // ModulConfig of a legacy layout is migrated by migrateModulConfig, unset memory is set to default values
+        uint16_t trackConfigVersion;
+        std::array<TrackConfig, 8> trackConfig;
         std::array<uint16_t, 8> voltageOffset;
     } ModulConfig;
 
-    FeedbackDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+    // stored behind all other memory data, so that their offsets do not change, memory of older firmware reads 0xFFFF
+    typedef struct
+    {
+        // current of a port is sent as event if it changed by this value, 0 disables events
+        uint16_t powerInfoDeltaINmA;
+    } PowerInfoConfig;
+
+    // layout of memory before trackConfigVersion, one trackConfig was used for all ports
+    typedef struct
+    {
+        uint16_t trackSetCurrentINmA;
+        uint16_t trackFreeToSetTimeINms;
+        uint16_t trackSetToFreeTimeINms;
+    } LegacyTrackConfig;
+
+    typedef struct
+    {
+        uint16_t networkId;
+        uint16_t modulAddress;
+        uint16_t sendChannel2Data;
+        LegacyTrackConfig trackConfig;
+        std::array<uint16_t, 8> voltageOffset;
+    } LegacyModulConfig;
+
+    // memory of modulConfig was written with layout of LegacyModulConfig, so every field behind sendChannel2Data and all data
+    // behind modulConfig are read from wrong offsets
+    static bool isLegacyModulConfig(const ModulConfig &modulConfig);
+
+    // values of legacy layout are in the range the legacy firmware could use, otherwise memory is of unknown layout
+    static bool isValidLegacyModulConfig(const LegacyModulConfig &legacyConfig);
+
+    // settings of legacy layout, every port gets the one trackConfig, unset legacy memory is left for default values of begin()
+    static void migrateModulConfig(const LegacyModulConfig &legacyConfig, ModulConfig &modulConfig);
+
+    FeedbackDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                     int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...) = nullptr,
                     bool debug = false, bool zcanDebug = false);
     virtual ~FeedbackDecoder();
@@ -57,6 +96,12 @@ public:
 
     virtual void callbackAdcReadFinished(ADC_HandleTypeDef *hadc);
 
+    virtual void callbackAdcReadHalfFinished(ADC_HandleTypeDef *hadc);
+
+    virtual void callbackAdcWatchdog(ADC_HandleTypeDef *hadc);
+
+    virtual void callbackAdcInjectedFinished(ADC_HandleTypeDef *hadc);
+
 protected:
     // configure input pins for feedback function
     virtual void configInputs();
@@ -71,6 +116,8 @@ protected:
     virtual bool onAccessoryPort6(uint16_t accessoryId, uint8_t port, uint8_t type) override;
     // reaction on request of modul info
     virtual bool onRequestModulInfo(uint16_t id, uint16_t type) override;
+    // reaction on request of modul power info, current of ports 0 up to 7 is answered, voltage is 0
+    virtual bool onRequestModulPowerInfo(uint16_t id, uint8_t port) override;
     // reaction on event of modul power info
     virtual bool onModulPowerInfoEvt(uint16_t nid, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA) override;
     // reaction on acknowledge of modul power info
@@ -92,13 +139,38 @@ protected:
 
     void checkPortStatusChange(bool state);
 
+    // filter current of m_detectionPort, port is occupied above set voltage and free again below free voltage
+    void checkPortCurrent(uint16_t currentVoltage);
+
+    // thresholds of port in adc counts from its configuration
+    void updateTrackThresholds(uint8_t port);
+
+    static void setDefaultTrackConfig(TrackConfig &trackConfig);
+
+    // value of track configuration which is addressed by object config tag, port is returned, nullptr if tag is no track configuration
+    uint16_t *findTrackConfigValue(uint32_t tag, uint8_t &port);
+
+    // minimum or maximum current of port which is addressed by object config tag, port is returned, nullptr if tag is no current range
+    uint16_t *findCurrentRangeValue(uint32_t tag, uint8_t &port);
+
     void checkDelayedStatusChange();
 
+    // send current of ports which changed by more than powerInfoDeltaINmA
+    void cyclicPowerInfo();
+
+    // filtered current of port
+    uint16_t getCurrentINmA(uint8_t port);
+
+    // follow drift of idle value of port, value is ignored if it differs too much from current offset
+    void trackVoltageOffset(uint8_t port, uint16_t idleValue);
+
     virtual void onBlockOccupied();
     virtual void onBlockEmpty(size_t blockNum);
 
     ModulConfig &m_modulConfig;
 
+    PowerInfoConfig &m_powerInfoConfig;
+
     uint32_t m_firmwareVersion{0x05010014}; // 5.1.20
     uint32_t m_buildDate{0x07E60917};       // 23.09.2022
     uint32_t m_hardwareVersion{0x05010001}; // 5.1.1
@@ -141,12 +213,52 @@ protected:
         bool reportedState;
         bool changeReported;
         uint16_t voltageOffset;
+        // voltageOffset with m_voltageOffsetFilterShift fractional bits
+        int32_t filteredVoltageOffset;
+        // thresholds of occupancy in adc counts
+        uint16_t setVoltage;
+        uint16_t freeVoltage;
+        // exponentially weighted current with m_currentFilterFractionBits fractional bits
+        int32_t filteredCurrent;
+        // range of single measurements since it was restarted by object config tag
+        uint16_t minCurrentINmA;
+        uint16_t maxCurrentINmA;
+        uint16_t reportedCurrentINmA;
+        uint32_t powerInfoTimeINms;
         uint32_t lastChangeTimeINms;
     } TrackData;
 
     std::array<TrackData, 8> m_trackData;
 
-    uint16_t m_trackSetVoltage{0};
+    static constexpr uint16_t currentTrackConfigVersion{0xC001};
+
+    // 3300mV per 4096 bits is 0.8mVperCount
+    // I have a 22 Ohm resistor so 0.8mV per Count * 22 * current is offset down below
+    // so I take 8*22 = 17,6 is round about 18
+    const uint16_t m_countsPerMilliAmpere{18};
+
+    // object config tags 0x006011pp and 0x006012pp of ports 1 up to 8 read minimum and maximum current of single measurements
+    // since the range was restarted, writing one of them restarts range of its port
+    static constexpr uint32_t powerInfoMinTag{0x00601100};
+    static constexpr uint32_t powerInfoMaxTag{0x00601200};
+    // events of one port are sent at most once in this interval
+    const uint32_t m_powerInfoIntervalINms{1000};
+
+    // set current above full range of 12 bit adc with 18 counts per mA is never reached
+    static constexpr uint16_t maxLegacyTrackSetCurrentINmA{4095 / 18};
+    static constexpr uint16_t maxVoltageOffset{4095};
+
+    const uint8_t m_currentFilterFractionBits{8};
+
+    const uint16_t m_maxTrackFilterShift{8};
 
     uint8_t m_detectionPort{0};
+
+    // weight of a new idle value is 1/256, so that noise and occupied blocks have nearly no influence
+    const uint8_t m_voltageOffsetFilterShift{8};
+    // offset is saved only if it differs from saved value by more than tolerance
+    const uint16_t m_voltageOffsetSaveTolerance{8};
+    // writing flash blocks cpu, so offset is saved at most once in this interval
+    const uint32_t m_voltageOffsetSaveIntervalINms{600000}; // 10 min
+    uint32_t m_voltageOffsetSaveTimeINms{0};
 };
\ No newline at end of file
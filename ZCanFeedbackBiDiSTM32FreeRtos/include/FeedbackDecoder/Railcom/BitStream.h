@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Railcom BitStream
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Sliced railcom samples packed into 32 bit words
+// Sample i is stored MSB first in word i / 32, so that count leading zeros
+// returns directly the offset of the first matching sample inside of a word.
+// A set bit is an idle sample which is a logical one of the uart.
+
+template <std::size_t SAMPLE_SIZE>
+class RailcomBitStream
+{
+public:
+    static constexpr std::size_t wordSize{(SAMPLE_SIZE + 31) / 32};
+
+    RailcomBitStream() : m_words{} {};
+
+    // convert adc samples [startIndex, endIndex) to logical uart levels
+    // slicing starts at the word boundary before startIndex, so that a stream can be filled part by part
+    // stride is the number of ports that are interleaved in samples
+    void slice(const uint16_t *samples, std::size_t startIndex, std::size_t endIndex, uint16_t voltageOffset, uint16_t trackSetVoltage, std::size_t stride = 1)
+    {
+        std::size_t maxLength{endIndex > SAMPLE_SIZE ? SAMPLE_SIZE : endIndex};
+        std::size_t index{startIndex & ~static_cast<std::size_t>(31)};
+        // |sample - offset| < trackSetVoltage as one unsigned compare
+        const uint32_t idleWindow{(0 != trackSetVoltage) ? (2u * trackSetVoltage - 1u) : 0u};
+        for (std::size_t word = (index >> 5); (word < wordSize) && (index < maxLength); word++)
+        {
+            uint32_t value{0};
+            std::size_t endOfWord{(index + 32) > maxLength ? maxLength : (index + 32)};
+            std::size_t numberOfSamples{endOfWord - index};
+            for (; index < endOfWord; index++)
+            {
+                // shift in sample by sample, so that first sample ends up as MSB
+                int32_t deviation{static_cast<int32_t>(samples[index * stride]) - static_cast<int32_t>(voltageOffset)};
+                uint32_t idle{(static_cast<uint32_t>(deviation + trackSetVoltage - 1) < idleWindow) ? 1u : 0u};
+                value = (value << 1) | idle;
+            }
+            // samples after endIndex are zero
+            m_words[word] = value << (32 - numberOfSamples);
+        }
+    }
+
+    bool get(std::size_t index) const
+    {
+        return 0 != ((m_words[index >> 5] << (index & 31)) & 0x80000000u);
+    }
+
+    // search for first negative flank (one followed by zero) in [startIndex, endIndex)
+    // returns true if successful
+    bool findFallingEdge(std::size_t startIndex, std::size_t endIndex, std::size_t &foundIndex) const
+    {
+        std::size_t word{startIndex >> 5};
+        uint32_t mask{0xFFFFFFFFu >> (startIndex & 31)};
+        while ((word < wordSize) && ((word << 5) < endIndex))
+        {
+            uint32_t current{m_words[word]};
+            uint32_t following{(word + 1) < wordSize ? m_words[word + 1] : 0};
+            // a one in current whose successor sample is zero
+            uint32_t edges{current & ~((current << 1) | (following >> 31)) & mask};
+            if (0 != edges)
+            {
+                std::size_t index{(word << 5) + static_cast<std::size_t>(__builtin_clz(edges))};
+                if (index < endIndex)
+                {
+                    foundIndex = index;
+                    return true;
+                }
+                return false;
+            }
+            mask = 0xFFFFFFFFu;
+            word++;
+        }
+        return false;
+    }
+
+    // returns 32 samples starting with index, where sample index is MSB
+    uint32_t window(std::size_t index) const
+    {
+        std::size_t word{index >> 5};
+        uint32_t shift{static_cast<uint32_t>(index & 31)};
+        uint32_t value{m_words[word] << shift};
+        if ((0 != shift) && ((word + 1) < wordSize))
+        {
+            value |= m_words[word + 1] >> (32 - shift);
+        }
+        return value;
+    }
+
+private:
+    std::array<uint32_t, wordSize> m_words;
+};
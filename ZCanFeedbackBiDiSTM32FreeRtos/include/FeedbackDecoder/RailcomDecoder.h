@@ -20,12 +20,75 @@
 #include <array>
 #include "FeedbackDecoder/FeedbackDecoder.h"
 #include "FeedbackDecoder/Railcom/Packet.h"
+#include "FeedbackDecoder/Railcom/Codec.h"
+#include "FeedbackDecoder/Railcom/BitStream.h"
 #include <STM32FreeRTOS.h>
 
+// print every analyzed railcom capture in the replay format of the native environment
+//#define RAILCOM_TRACE
+
+// capture two neighbouring ports per cutout with scan mode of adc, so that every port is sampled each 2us
+//#define RAILCOM_SCAN_MODE
+
+// capture two neighbouring ports per cutout with adc1 and adc2 in dual regular simultaneous mode, every port is sampled each 1us
+//#define RAILCOM_DUAL_ADC_MODE
+
+// capture one port per cutout with 2us per sample by adc clock of 7 MHz, so that capture buffers need half of ram
+//#define RAILCOM_DECIMATION_MODE
+
+#if defined(RAILCOM_DECIMATION_MODE) && (defined(RAILCOM_SCAN_MODE) || defined(RAILCOM_DUAL_ADC_MODE))
+#error "RAILCOM_DECIMATION_MODE samples a single port per cutout"
+#endif
+
+// detect occupancy by analog watchdog of adc on a circular scan of all ports, ports are only evaluated after a sample left the window
+//#define OCCUPANCY_WATCHDOG_MODE
+
+// measure occupancy of all ports by a circular scan, which runs without dcc packets, ports are averaged in dma callbacks
+//#define OCCUPANCY_SCAN_MODE
+
+#if defined(OCCUPANCY_WATCHDOG_MODE) && defined(OCCUPANCY_SCAN_MODE)
+#error "OCCUPANCY_WATCHDOG_MODE and OCCUPANCY_SCAN_MODE use the same scan in a different way"
+#endif
+
+// measure occupancy by injected group of adc2 triggered by TIM4, so that it runs at the same time as railcom captures of adc1
+//#define OCCUPANCY_INJECTED_MODE
+
+#if (defined(OCCUPANCY_WATCHDOG_MODE) || defined(OCCUPANCY_SCAN_MODE)) && defined(RAILCOM_DUAL_ADC_MODE)
+#error "circular scan of OCCUPANCY_WATCHDOG_MODE and OCCUPANCY_SCAN_MODE needs adc1 in independent mode, RAILCOM_DUAL_ADC_MODE keeps dual mode"
+#endif
+
+#if defined(OCCUPANCY_INJECTED_MODE) && (defined(OCCUPANCY_WATCHDOG_MODE) || defined(OCCUPANCY_SCAN_MODE) || defined(RAILCOM_DUAL_ADC_MODE))
+#error "OCCUPANCY_INJECTED_MODE needs adc2 for itself and measures occupancy without regular conversions"
+#endif
+
+// start railcom capture by timer at a fixed delay after last edge of dcc packet instead of software start in callbackDccReceived
+// XPOM datagrams of 6 symbols need 240us of channel 2, they only fit into the capture window of the timer trigger,
+// so they are forwarded as accessory data only if it is defined
+//#define RAILCOM_TIMER_TRIGGER
+
+// number of consistent observations of id 1 and of id 2 of channel 1 before an address is reported
+#define RAILCOM_CHANNEL1_THRESHOLD 1
+
+// samples of one capture buffer, native environment captures every mode with the largest buffer
+#ifndef RAILCOM_CAPTURE_SAMPLES
+#if defined(RAILCOM_DUAL_ADC_MODE)
+#define RAILCOM_CAPTURE_SAMPLES 800
+#elif defined(RAILCOM_DECIMATION_MODE)
+#define RAILCOM_CAPTURE_SAMPLES 200
+#else
+#define RAILCOM_CAPTURE_SAMPLES 400
+#endif
+#endif
+
+// locos of which dyn values are kept, every loco needs 64 bytes of ram
+#ifndef RAILCOM_TELEMETRY_LOCOS
+#define RAILCOM_TELEMETRY_LOCOS 8
+#endif
+
 class RailcomDecoder : public FeedbackDecoder
 {
 public:
-    RailcomDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+    RailcomDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                    int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...) = nullptr,
                    bool debug = false, bool zcanDebug = false, bool railcomDebug = false);
     virtual ~RailcomDecoder() override;
@@ -38,19 +101,42 @@ public:
 
     virtual void callbackAdcReadFinished(ADC_HandleTypeDef *hadc) override;
 
+    virtual void callbackAdcReadHalfFinished(ADC_HandleTypeDef *hadc) override;
+
+    virtual void callbackAdcWatchdog(ADC_HandleTypeDef *hadc) override;
+
+    virtual void callbackAdcInjectedFinished(ADC_HandleTypeDef *hadc) override;
+
 protected:
     typedef struct
     {
         uint16_t address{0};
         uint16_t direction{0};
+        // consecutive observations of other direction, direction is changed after m_directionChangeObservations
+        uint8_t directionChanges{0};
         uint32_t lastChangeTimeINms{0};
         bool changeReported{true};
     } RailcomAddr;
 
+    typedef struct
+    {
+        uint8_t value{0};
+        uint8_t hits{0};
+    } Channel1Candidate;
+
+    // candidates of value of one id of channel 1
+    typedef std::array<Channel1Candidate, 2> Channel1Votes;
+
     typedef struct RailcomData
     {
         std::array<RailcomAddr, 4> railcomAddr;
-        std::array<RailcomPacket12Bit, 2> channel1Data;
+        // votes of id 1 and id 2
+        std::array<Channel1Votes, 2> channel1Votes;
+        // last service request of an accessory decoder, it is repeated after every accessory packet
+        uint16_t srqAddress{0};
+        uint32_t srqTimeINms{0};
+        // captures with framing errors in channel 1 while port was occupied, clean captures decay it
+        uint8_t collisionHits{0};
     } RailcomData;
 
     enum class Channel : uint8_t
@@ -63,13 +149,16 @@ protected:
     typedef struct RailcomByte
     {
         uint8_t data;
-        int8_t direction;
+        // signed sum of offset corrected samples of zero bits and sum of their absolute values
+        int32_t polarity;
+        uint32_t magnitude;
         size_t startIndex;
         size_t endIndex;
         bool valid;
 
         RailcomByte() : data(0xFF),
-                        direction(0),
+                        polarity(0),
+                        magnitude(0),
                         startIndex(1),
                         endIndex(0),
                         valid(false){
@@ -80,12 +169,103 @@ protected:
     typedef struct RailcomChannelData
     {
         size_t size;
+        // start bits which were not followed by a valid 4 of 8 code
+        size_t framingErrors;
         std::array<RailcomByte, 8> bytes;
-        RailcomChannelData() : size(0){
+        RailcomChannelData() : size(0),
+                               framingErrors(0){
 
                                };
     } RailcomChannelData;
 
+    enum class Channel2Type : uint8_t
+    {
+        eUnknown,
+        ePom,
+        eAdr,
+        eExt,
+        eDyn,
+        eXpom,
+        eCvAuto,
+        eStat4,
+        eStat1,
+        eTime,
+        eError
+    };
+
+    // format of datagrams of channel 2 indexed by id
+    typedef struct
+    {
+        // 6 bit symbols including id, 0 if id is unknown
+        uint8_t numberOfSymbols;
+        Channel2Type type;
+        // accessory data type of zcan, 0 if datagram is not forwarded
+        uint8_t accessoryDataType;
+    } Channel2Format;
+
+    typedef struct
+    {
+        Channel2Type type;
+        uint8_t id;
+        // data bits without id, first received bit is MSB
+        uint32_t value;
+        uint16_t direction;
+        uint8_t confidence;
+    } Channel2Datagram;
+
+    static constexpr uint8_t maxChannel2Datagrams{4};
+
+    // value of dyn datagram which is pushed as accessory data on change
+    typedef struct
+    {
+        uint8_t subindex;
+        uint8_t accessoryDataType;
+        // smaller changes are only sent after maxIntervalINms
+        uint8_t deadband;
+        uint16_t minIntervalINms;
+        uint16_t maxIntervalINms;
+    } TelemetryFormat;
+
+    // 8 bytes, entries are zeroed by value initialization
+    typedef struct
+    {
+        uint32_t lastReportTimeINms;
+        // speed needs 9 bits, all other values 8 bits
+        uint16_t value : 9;
+        uint16_t received : 1;
+        uint16_t reported : 1;
+        uint16_t reportedValue;
+    } TelemetryValue;
+
+    // speed, qos, temperature and level of container 1 to 4
+    static constexpr uint8_t numberOfTelemetryValues{7};
+
+    // latest dyn values of a loco
+    typedef struct
+    {
+        uint16_t address{0};
+        // port on which last dyn datagram was received
+        uint8_t port{0};
+        uint32_t lastUpdateTimeINms{0};
+        std::array<TelemetryValue, numberOfTelemetryValues> values;
+    } LocoTelemetry;
+
+    typedef RailcomBitStream<400> BitStream;
+
+    // railcom timing in samples of one port
+    typedef struct
+    {
+        size_t startChannel1;
+        size_t endOfChannel1;
+        size_t startChannel2;
+        size_t firstDataBit; // middle of first data bit after falling edge of start bit
+        size_t bitLength;
+        size_t byteLength;
+        size_t maxByteGap; // bytes of one datagram follow directly
+    } RailcomTiming;
+
+    static constexpr uint8_t maxPortsPerCapture{2};
+
     enum class AddressType : uint8_t
     {
         eNone,
@@ -93,6 +273,89 @@ protected:
         eAcc
     };
 
+    // symbols of channel 1 which are needed to evaluate it as loco address or accessory srq
+    typedef struct
+    {
+        bool framingError{false};
+        // first two symbols which follow directly
+        bool srqFound{false};
+        uint16_t srq{0};
+        // first id 1 or id 2 datagram
+        bool locoFound{false};
+        uint8_t locoId{0};
+        uint8_t locoValue{0};
+        uint16_t direction{0};
+        uint8_t confidence{0};
+    } Channel1Result;
+
+    enum class CaptureState : uint8_t
+    {
+        eFree,
+        eCapturing,
+        eChannel1Ready, // half transfer done
+        eComplete
+    };
+
+    // buffer of one cutout, owned by adc while capturing and by cyclicPortCheck afterwards
+    // samples of all ports of a capture are interleaved
+    typedef struct
+    {
+        // 400us after end of dcc packet, half transfer is done after channel 1
+        std::array<uint16_t, RAILCOM_CAPTURE_SAMPLES> samples;
+        volatile CaptureState state{CaptureState::eFree};
+        // channel 1 of every port, it is evaluated when address type of dcc packet is known
+        std::array<Channel1Result, maxPortsPerCapture> channel1;
+        // first track port of capture
+        uint8_t port{0};
+        // number of samples, half of capture if adc was released after channel 1
+        size_t length{0};
+        bool channel1Analyzed{false};
+        bool channel1Evaluated{false};
+        bool channel2Data{false};
+        AddressType addrReceived{AddressType::eNone};
+        uint16_t lastRailcomAddress{0};
+    } RailcomCapture;
+
+    static constexpr uint8_t numberOfRailcomCaptures{2};
+
+    static constexpr uint8_t noRailcomCapture{0xFF};
+
+    static constexpr uint8_t noRailcomPort{0xFF};
+
+    typedef struct
+    {
+        uint16_t address{0};
+        uint8_t port{0};
+    } LocoPort;
+
+    // counters of decode quality of a port, they only count up and wrap around
+    typedef struct
+    {
+        uint32_t cutouts{0};
+        uint32_t startBits{0};
+        // start bits without valid 4 of 8 code
+        uint32_t invalidSymbols{0};
+        uint32_t channel1Addresses{0};
+        uint32_t channel2Acks{0};
+        uint32_t channel2Nacks{0};
+        // cpu cycles to analyze channel 1 and 2 of last cutout and maximum since reset
+        uint32_t lastAnalysisCycles{0};
+        uint32_t maxAnalysisCycles{0};
+    } RailcomStatistics;
+
+    static constexpr uint32_t railcomStatisticsTag{0x00E01000};
+
+    // current sense of one port in a pass of circular scan
+    typedef struct
+    {
+        // sums of samples of running pass
+        uint32_t deviationSum{0};
+        uint32_t sampleSum{0};
+        // means of last complete pass
+        uint16_t deviation{0};
+        uint16_t idleValue{0};
+    } CurrentSense;
+
     virtual void configAdcSingleMode() = 0;
 
     virtual void configAdcDmaMode() = 0;
@@ -101,6 +364,38 @@ protected:
 
     virtual void triggerDmaRead(int channel, uint32_t *data, uint32_t length) = 0;
 
+    // samples of channels are interleaved in data
+    virtual void triggerScanDmaRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length) = 0;
+
+    // channel1 and channel2 are sampled at the same time, length is number of sample pairs
+    virtual void triggerDualDmaRead(int channel1, int channel2, uint32_t *data, uint32_t length) = 0;
+
+    // current sense of two ports in dual mode, started at once by software, length is number of sample pairs
+    virtual void triggerDualCurrentSenseRead(int channel1, int channel2, uint32_t *data, uint32_t length) = 0;
+
+    virtual void stopDmaRead() = 0;
+
+    // circular scan of channels until stopDmaRead with a sample of every channel each 48us, samples of channels are interleaved in data
+    // half and complete callbacks are called for every pass through data if transferInterrupts is set
+    virtual void triggerCircularScanRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length, bool transferInterrupts) = 0;
+
+    // callbackAdcWatchdog is called for a sample of scan outside of [lowThreshold, highThreshold]
+    virtual void armWatchdog(uint16_t lowThreshold, uint16_t highThreshold) = 0;
+
+    virtual void disarmWatchdog() = 0;
+
+    // channels are converted in groups of 4 by injected group of second adc every periodINus, callbackAdcInjectedFinished is called after each group
+    virtual void triggerInjectedRead(const int *channels, size_t numberOfChannels, uint16_t periodINus) = 0;
+
+    // group of 4 channels which is converted on next trigger
+    virtual void setInjectedChannels(const int *channels) = 0;
+
+    // result of rank 0 up to 3 of last injected conversion
+    virtual uint16_t readInjectedValue(uint8_t rank) = 0;
+
+    // free running cycle counter of cpu
+    virtual uint32_t readCycleCounter() = 0;
+
     // configure input pins for feedback function
     void configInputs() override;
 
@@ -112,13 +407,146 @@ protected:
     // reaction on Accessory Data message
     virtual bool onAccessoryData(uint16_t accessoryId, uint8_t port, uint8_t type) override;
 
-    void analyzeRailcomData(uint16_t dmaBufferIN1samplePer1us[], size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage);
+    // statistics of port are requested by tags 0x00E010pp up to 0x00E710pp
+    virtual bool onRequestModulObjectConfig(uint16_t id, uint32_t tag) override;
+
+    // writing tag 0x00E010pp resets statistics of port
+    virtual bool onCmdModulObjectConfig(uint16_t id, uint32_t tag, uint16_t value) override;
+
+    // counters of port since last reset, wrapped to 16 bits
+    uint16_t getRailcomStatistic(uint8_t port, uint8_t index);
+
+    // count start bits and invalid symbols of analyzed channel of port and add cycles to analysis time of cutout
+    void countRailcomAnalysis(uint8_t port, const RailcomChannelData &channel, uint32_t cycles);
+
+    // number of ports sampled in one cutout and time between two samples of a port
+    void configRailcomCapture(uint8_t portsPerCapture, uint8_t samplePeriodINus);
+
+    // select port of capture which is analyzed by the following calls
+    void selectRailcomCapturePort(uint16_t samples[], uint8_t firstPort, uint8_t capturePort);
+
+    // analyze channel 1 as soon as first length samples of cutout are available
+    void analyzeRailcomChannel1(RailcomChannelData &channel1, size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage, Channel1Result &result);
+
+    // vote loco address or notify srq of analyzed port depending on m_addrReceived
+    void evaluateRailcomChannel1(const Channel1Result &result);
 
-    bool getStartAndStopByteOfUart(bool *bitStreamIN1samplePer1us, size_t startIndex, size_t endIndex, size_t *findStartIndex, size_t *findEndIndex);
+    // observations needed to accept a value of channel 1 and maximum hits of a candidate
+    void configChannel1Voting(uint8_t threshold, uint8_t maxHits);
 
-    void handleBitStream(uint16_t dmaBufferIN1samplePer1us[], size_t length, RailcomChannelData &channel1, RailcomChannelData &channel2, uint16_t voltageOffset, uint16_t trackSetVoltage);
+    // count observed value, other candidates decay
+    void voteChannel1(Channel1Votes &votes, uint8_t value);
 
-    void handleFoundLocoAddr(uint16_t locoAddr, uint16_t direction, Channel channel, std::array<uint16_t, 4> &railcomData);
+    // true if a candidate has more hits than the other one and at least m_channel1Threshold
+    bool getChannel1Value(const Channel1Votes &votes, uint8_t &value);
+
+    // mean of runs of 32 idle samples in [startIndex, endIndex) of sliced port is used to track voltage offset
+    void trackRailcomIdleValue(size_t startIndex, size_t endIndex);
+
+    // true if a start bit of channel 2 is within the first length samples
+    bool hasChannel2Data(size_t length);
+
+    // analyze channel 2 after channel 1 was analyzed with startIndex samples
+    void analyzeRailcomChannel2(RailcomChannelData &channel2, size_t startIndex, size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage);
+
+    // split bytes of channel 2 up to NACK, ACK or BUSY into datagrams with formats of loco or accessory ids, returns number of datagrams
+    size_t parseChannel2(const RailcomChannelData &channel2, std::array<Channel2Datagram, maxChannel2Datagrams> &datagrams,
+                         const std::array<Channel2Format, 16> &formats);
+
+    // forward datagram of loco or accessory as accessory data, value1 is dcc address
+    bool notifyChannel2Datagram(uint8_t port, uint16_t address, uint8_t type, const Channel2Datagram &datagram);
+
+    // srq is sent again if address changed or after m_srqRepeatINms
+    bool notifyAccessorySrq(uint8_t port, uint16_t accAddr, bool extended);
+
+    // store value of dyn datagram in telemetry of loco, false if subindex is no telemetry value
+    bool updateTelemetry(uint8_t port, uint16_t locoAddr, uint8_t subindex, uint8_t value);
+
+    // send value if it changed by deadband after min interval or changed at all after max interval
+    bool checkTelemetryValue(LocoTelemetry &telemetry, uint8_t index, uint32_t currentTimeINms);
+
+    // send pending values and remove telemetry of locos which were not seen since timeout, one loco per call
+    void cyclicTelemetryCheck();
+
+    // analyze channel 1 of all ports of capture and release adc if there is no channel 2
+    void analyzeRailcomCaptureChannel1(RailcomCapture &capture);
+
+    // evaluate channel 1 of all ports of capture with address type of its dcc packet
+    void evaluateRailcomCaptureChannel1(RailcomCapture &capture);
+
+    // stop capture after channel 1, if it is still running
+    void releaseRailcomCapture(RailcomCapture &capture);
+
+    // hand buffer back to adc
+    void finishRailcomMeasurement(RailcomCapture &capture);
+
+    // select ports of next capture
+    void prepareNextRailcomCapture();
+
+    // weighted round robin over occupied ports, returns first port of next capture
+    uint8_t selectNextRailcomPort();
+
+    // 0 if no loco is able to answer on port
+    uint8_t getRailcomPortWeight(uint8_t port, uint32_t currentTimeINms);
+
+    // port on which loco was seen last or noRailcomPort
+    uint8_t findLocoPort(uint16_t locoAddr);
+
+    bool isRailcomAddrKnown(uint8_t port, uint16_t locoAddr);
+
+    // channel 1 of several locos on port overlaps, addresses have to be confirmed by channel 2
+    bool hasChannel1Collision(uint8_t port);
+
+    // next port with collision after last one or noRailcomPort
+    uint8_t findCollisionPort();
+
+    void updateLocoPortIndex(uint16_t locoAddr, uint8_t port);
+
+    // entry is only removed if loco was seen last on port
+    void removeFromLocoPortIndex(uint16_t locoAddr, uint8_t port);
+
+    // current sense uses adc as long as no railcom capture is running
+    void triggerCurrentSense();
+
+    // occupancy of m_detectionPort by samples firstSample, firstSample + step, ... of current sense buffer
+    void evaluateCurrentSense(size_t firstSample, size_t step);
+
+    // occupancy of m_detectionPort by mean absolute deviation from offset, mean of samples is idle value of empty port
+    void checkCurrentSense(uint16_t deviation, uint16_t idleValue);
+
+    // add samples [startIndex, endIndex) of circular scan to sums of ports, called by dma callbacks
+    void accumulateCurrentSense(size_t startIndex, size_t endIndex);
+
+    void addCurrentSenseSample(uint8_t port, uint16_t measurement);
+
+    // means of sums of every port for cyclicPortCheck, sums start again
+    void publishCurrentSense(uint32_t numberOfSamples);
+
+    // evaluate all ports of scan after watchdog was triggered and every m_watchdogEvaluationIntervalINms while a port is occupied
+    void cyclicWatchdogCheck();
+
+    // a sample inside of window is inside of detection threshold of every port
+    void getWatchdogWindow(uint16_t &lowThreshold, uint16_t &highThreshold);
+
+    bool getStartAndStopByteOfUart(const BitStream &bitStream, size_t startIndex, size_t endIndex, size_t *findStartIndex, size_t *findEndIndex);
+
+    // slice samples [startIndex, endIndex) of selected port into its bit stream, startIndex 0 begins a new cutout
+    // threshold is half of railcom current of first start bit of cutout, trackSetVoltage as long as there is none
+    void handleBitStream(size_t startIndex, size_t endIndex, uint16_t voltageOffset, uint16_t trackSetVoltage);
+
+    // railcom current of first start bit in [startIndex, endIndex) of port, 0 if there is none
+    uint16_t measureRailcomStartBit(size_t startIndex, size_t endIndex, uint16_t voltageOffset);
+
+    // get uart bytes of bit stream of selected port inside of search window
+    void analyzeStream(RailcomChannelData &channel, size_t startOfSearch, size_t endOfSearch, uint16_t voltageOffset);
+
+    // add samples of zero bit around middleIndex to polarity of byte
+    void integrateZeroBit(RailcomByte &byte, size_t middleIndex, uint16_t voltageOffset);
+
+    // direction 0x10 or 0x11 by sign of polarity of bytes, 0 if confidence in percent is below m_directionMinConfidence
+    uint16_t getRailcomDirection(const RailcomByte *bytes, size_t numberOfBytes, uint8_t &confidence);
+
+    void handleFoundLocoAddr(uint16_t locoAddr, uint16_t direction, uint8_t confidence, Channel channel, std::array<uint16_t, 4> &railcomData);
 
     // address is 0x8000 up tp 0xC000
     bool notifyLocoInBlock(uint8_t port, std::array<RailcomAddr, 4> railcomAddr);
@@ -128,16 +556,75 @@ protected:
     std::array<uint16_t, 128> m_adcDmaBufferCurrentSense;
     
     SemaphoreHandle_t m_currentSenseDataReady;
-    SemaphoreHandle_t m_railcomSenseDataReady;
 
-    bool m_currentSenseRunning{false};
-    bool m_railcomSenseRunning{false};
+    // measurement of all ports is in progress
+    volatile bool m_currentSenseRunning{false};
+    // dma of one port is running, it is aborted by a railcom capture
+    volatile bool m_currentSenseDmaRunning{false};
+    volatile bool m_railcomSenseRunning{false};
+
+    // watchdog is armed while no port is occupied, otherwise every sample would trigger it
+    volatile bool m_watchdogArmed{true};
+    // a sample left window of watchdog, ports are evaluated by cyclicPortCheck
+    volatile bool m_watchdogTriggered{false};
+
+    uint32_t m_watchdogEvaluationTimeINms{0};
+
+    const uint32_t m_watchdogEvaluationIntervalINms{4};
+
+    std::array<CurrentSense, 8> m_currentSense;
 
-    std::array<uint16_t, 512> m_adcDmaBufferRailcom;
+    static constexpr uint8_t injectedChannels{4};
 
+    // group of ports of next injected conversion
+    uint8_t m_injectedGroup{0};
 
-    uint16_t *m_dmaBufferIN1samplePer1us;
+    uint8_t m_injectedPasses{0};
 
+    // every port is sampled each 200us, means of 16 samples are evaluated
+    const uint16_t m_injectedTriggerPeriodINus{100};
+
+    const uint8_t m_injectedPassesPerMean{16};
+
+    // next cutout is captured while previous one is analyzed
+    std::array<RailcomCapture, numberOfRailcomCaptures> m_railcomCaptures;
+
+    // capture which is running or started next
+    volatile uint8_t m_railcomCaptureIndex{0};
+
+    // captures are analyzed in the order they were taken
+    uint8_t m_railcomAnalysisIndex{0};
+
+    // capture of last dcc packet which receives its address
+    volatile uint8_t m_railcomAddressIndex{noRailcomCapture};
+
+    // number of samples of one capture
+    size_t m_railcomCaptureLength{400};
+
+    uint8_t m_railcomPortsPerCapture{1};
+
+    uint8_t m_railcomSamplePeriodINus{1};
+
+    RailcomTiming m_railcomTiming;
+
+    std::array<BitStream, maxPortsPerCapture> m_bitStream;
+
+    // slicing threshold of cutout, half of railcom current of first start bit, 0 if no start bit was found yet
+    std::array<uint16_t, maxPortsPerCapture> m_railcomSliceThreshold{};
+
+    // a start bit needs at least 8 mA railcom current, so that noise is not taken as start bit
+    const uint16_t m_railcomMinBitVoltage{18 * 8};
+
+    // port of capture which is analyzed
+    uint8_t m_railcomCapturePort{0};
+
+    // track port of m_railcomCapturePort
+    uint8_t m_railcomAnalyzedPort{0};
+
+    // first sample of analyzed port
+    uint16_t *m_railcomSamples;
+
+    // dcc address of analyzed capture
     uint16_t m_lastRailcomAddress{0};
 
     AddressType m_addrReceived{AddressType::eNone};
@@ -149,6 +636,12 @@ protected:
 
     std::array<RailcomData, 8> m_railcomData;
 
+    std::array<RailcomStatistics, 8> m_railcomStatistics;
+
+    // counters at last reset, reported values are differences, so that they stay valid if a counter wraps around
+    std::array<RailcomStatistics, 8> m_railcomStatisticsReset;
+
+    // first port of next capture
     uint8_t m_railcomDetectionPort{0};
 
     uint8_t m_cyclicRailcomCheckPort{0};
@@ -157,10 +650,65 @@ protected:
 
     const uint8_t m_maxNumberOfConsecutiveMeasurements{3};
 
+    // credit of first port of every capture, port with highest credit is captured next
+    std::array<uint16_t, 8> m_railcomPortCredit{};
+
+    // occupancy of port changed recently or no address is known
+    const uint8_t m_railcomWeightSearching{4};
+
+    // address is known but was not refreshed since m_railcomStableAddressINms
+    const uint8_t m_railcomWeightRefresh{2};
+
+    // address is known and was refreshed recently
+    const uint8_t m_railcomWeightStable{1};
+
+    const uint32_t m_railcomRecentChangeINms{1000};
+
+    const uint32_t m_railcomStableAddressINms{500};
+
+    // every address of m_railcomData with port on which it was seen last
+    std::array<LocoPort, 32> m_locoPortIndex;
+
+    // port of loco addressed by last dcc packet, it is captured in next cutout without counting as round robin measurement
+    volatile uint8_t m_railcomTargetPort{noRailcomPort};
+
+    // every second capture at most is targeted, so that round robin finds unknown locos
+    bool m_railcomCaptureTargeted{false};
+
+    const uint8_t m_railcomCollisionThreshold{2};
+
+    const uint8_t m_railcomCollisionMaxHits{4};
+
+    // packets to locos without known port target ports with collision one after another
+    uint8_t m_railcomCollisionPort{0};
+
+    uint8_t m_channel1Threshold{RAILCOM_CHANNEL1_THRESHOLD};
+
+    uint8_t m_channel1MaxHits{4};
+
     uint16_t m_channel1Direction{0};
 
     uint16_t m_channel2Direction{0};
 
-    static uint8_t encode4to8[];
-    static uint8_t encode8to4[];
+    // share of samples of zero bits which agree with direction of datagram
+    uint8_t m_channel1Confidence{0};
+
+    uint8_t m_channel2Confidence{0};
+
+    const uint8_t m_directionMinConfidence{50};
+
+    // direction of a known loco does not flicker with single disturbed datagrams
+    const uint8_t m_directionChangeObservations{3};
+
+    const uint32_t m_srqRepeatINms{1000};
+
+    std::array<LocoTelemetry, RAILCOM_TELEMETRY_LOCOS> m_locoTelemetry{};
+
+    uint8_t m_cyclicTelemetryCheckIndex{0};
+
+    static const std::array<Channel2Format, 16> channel2Formats;
+
+    static const std::array<Channel2Format, 16> accessoryChannel2Formats;
+
+    static const std::array<TelemetryFormat, numberOfTelemetryValues> telemetryFormats;
 };
@@ -22,7 +22,7 @@
 class RailcomDecoderStm32f1 : public RailcomDecoder
 {
 public:
-    RailcomDecoderStm32f1(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+    RailcomDecoderStm32f1(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                           int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...) = nullptr,
                           bool debug = false, bool zcanDebug = false, bool railcomDebug = false);
     virtual ~RailcomDecoderStm32f1() override;
@@ -35,4 +35,48 @@ protected:
     uint32_t singleAdcRead(int channel) override;
 
     void triggerDmaRead(int channel, uint32_t *data, uint32_t length) override;
+
+    void triggerScanDmaRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length) override;
+
+    void triggerDualDmaRead(int channel1, int channel2, uint32_t *data, uint32_t length) override;
+
+    void triggerDualCurrentSenseRead(int channel1, int channel2, uint32_t *data, uint32_t length) override;
+
+    void stopDmaRead() override;
+
+    void triggerCircularScanRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length, bool transferInterrupts) override;
+
+    void armWatchdog(uint16_t lowThreshold, uint16_t highThreshold) override;
+
+    void disarmWatchdog() override;
+
+    void triggerInjectedRead(const int *channels, size_t numberOfChannels, uint16_t periodINus) override;
+
+    void setInjectedChannels(const int *channels) override;
+
+    uint16_t readInjectedValue(uint8_t rank) override;
+
+    // DWT cycle counter, enabled in constructor
+    uint32_t readCycleCounter() override;
+
+    // select start of railcom capture by software or TIM1
+    void selectRailcomTrigger();
+
+    void startRailcomTrigger();
+
+    bool m_dualMode{false};
+
+    // dma of watchdog scan is circular
+    bool m_circularMode{false};
+
+    // cutout begins 26us up to 32us after last edge of packet end bit, capture starts 50us later
+    const uint16_t m_railcomTriggerDelayINus{79};
+
+#ifdef RAILCOM_DECIMATION_MODE
+    // adc clock is 7 MHz, 28.5 + 12.5 cycles are 5.9us per conversion of current sense
+    static constexpr uint32_t m_currentSenseSamplingTime{ADC_SAMPLETIME_28CYCLES_5};
+#else
+    // adc clock is 14 MHz, 71.5 + 12.5 cycles are 6us per conversion of current sense
+    static constexpr uint32_t m_currentSenseSamplingTime{ADC_SAMPLETIME_71CYCLES_5};
+#endif
 };
\ No newline at end of file
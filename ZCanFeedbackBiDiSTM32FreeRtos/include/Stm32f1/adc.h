@@ -51,6 +51,7 @@ const uint32_t channel[8]={ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHAN
 /* USER CODE END Includes */
 
 extern ADC_HandleTypeDef hadc1;
+extern ADC_HandleTypeDef hadc2;
 
 /* USER CODE BEGIN Private defines */
 
@@ -58,16 +59,58 @@ extern ADC_HandleTypeDef hadc1;
 
 void MX_ADC1_Init(void);
 
+void MX_ADC2_Init(void);
+
 /* USER CODE BEGIN Prototypes */
 
 void DMA1_Channel1_IRQHandler(void);
 
+void ADC1_2_IRQHandler(void);
+
 void configSingleMeasurementMode();
 
 void configContinuousDmaMode();
 
 void setChannel(int pin);
 
+// samples of pins are interleaved in the order of pins
+void setScanChannels(const int *pins, uint32_t numberOfChannels);
+
+// ADC_SAMPLETIME_xxx of every pin instead of 1.5 cycles
+void setScanChannelsSamplingTime(const int *pins, uint32_t numberOfChannels, uint32_t samplingTime);
+
+// ADC_SOFTWARE_START or ADC_EXTERNALTRIGCONV_xxx for start of regular conversion of ADC1
+void setExternalTrigger(uint32_t externalTrigConv);
+
+// ADC1 and ADC2 sample at the same time, ADC1 is master
+void configDualMode();
+
+// pin1 is sampled by ADC1 and pin2 by ADC2
+void setDualChannels(int pin1, int pin2);
+
+// DMA_NORMAL or DMA_CIRCULAR for next dma transfer of ADC1, dma must be stopped
+void setDmaMode(uint32_t mode);
+
+// no half and complete transfer interrupts of running dma transfer of ADC1
+void disableDmaTransferInterrupts();
+
+// interrupt on every conversion of a regular channel of ADC1 outside of [lowThreshold, highThreshold]
+void enableAnalogWatchdog(uint16_t lowThreshold, uint16_t highThreshold);
+
+void disableAnalogWatchdog();
+
+// sampling time and injected trigger of all pins for ADC2, first 4 pins are the injected sequence
+void configInjectedChannels(const int *pins, uint32_t numberOfPins, uint32_t samplingTime);
+
+// 4 pins of injected sequence of ADC2, they are converted on next trigger
+void setInjectedChannels(const int *pins);
+
+// injected sequence of ADC2 is converted on every trigger with interrupt after conversion
+void startInjectedConversion();
+
+// result of rank 0 up to 3 of injected sequence of ADC2
+uint16_t getInjectedValue(uint32_t rank);
+
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
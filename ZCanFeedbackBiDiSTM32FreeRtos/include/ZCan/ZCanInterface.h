@@ -240,6 +240,8 @@ protected:
     bool sendAccessoryPort6Ack(uint16_t accessoryId, uint8_t port, uint8_t type, uint16_t value);
 
     bool requestModulePowerInfo(uint16_t requestId);
+    bool sendModulePowerInfoEvt(uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA);
+    bool sendModulePowerInfoAck(uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA);
     bool requestModuleInfo(uint16_t nid, uint16_t type);
     bool getModuleInfo(uint16_t nid, uint16_t type, uint32_t info);
     bool sendModuleInfoAck(uint16_t type, uint32_t info);
@@ -271,6 +273,8 @@ private:
     void messageAccessoryPort6Ack(ZCanMessage &message, uint16_t accessoryId, uint8_t port, uint8_t type, uint16_t value);
 
     void messageRequestModulePowerInfo(ZCanMessage &message, uint16_t id);
+    void messageModulePowerInfoEvt(ZCanMessage &message, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA);
+    void messageModulePowerInfoAck(ZCanMessage &message, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA);
     void messageRequestModuleInfo(ZCanMessage &message, uint16_t id, uint16_t type);
     void messageCmdModuleInfo(ZCanMessage &message, uint16_t id, uint16_t type, uint32_t info);
     void messageModuleInfoAck(ZCanMessage &message, uint16_t type, uint32_t info);
@@ -0,0 +1,131 @@
+/*********************************************************************
+ * Native Arduino
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+// Minimal replacement of the Arduino and STM32 HAL API to compile the
+// decoder on a host. Time is simulated and advanced by the caller.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define F(string_literal) (string_literal)
+
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+#define UNUSED(X) (void)X
+
+enum
+{
+    PA0 = 0,
+    PA1,
+    PA2,
+    PA3,
+    PA4,
+    PA5,
+    PA6,
+    PA7,
+    PA8,
+    PA15 = 15,
+    PB0,
+    PB1,
+    PB3 = 19,
+    PB4,
+    PB5,
+    PB6,
+    PB7,
+    PB8,
+    PB9,
+    PB10,
+    PB11,
+    PB12,
+    PB13,
+    PB14,
+    PB15,
+    PC13 = 45
+};
+
+#define GPIO_PIN_0 0x0001
+#define GPIO_PIN_1 0x0002
+#define GPIO_PIN_2 0x0004
+#define GPIO_PIN_3 0x0008
+#define GPIO_PIN_4 0x0010
+#define GPIO_PIN_5 0x0020
+#define GPIO_PIN_6 0x0040
+#define GPIO_PIN_7 0x0080
+
+#define ADC_CHANNEL_0 0x00
+#define ADC_CHANNEL_1 0x01
+#define ADC_CHANNEL_2 0x02
+#define ADC_CHANNEL_3 0x03
+#define ADC_CHANNEL_4 0x04
+#define ADC_CHANNEL_5 0x05
+#define ADC_CHANNEL_6 0x06
+#define ADC_CHANNEL_7 0x07
+
+typedef struct
+{
+    uint32_t Instance;
+} ADC_HandleTypeDef;
+
+// simulated time which is set by native application
+extern uint32_t nativeTimeINms;
+
+uint32_t millis();
+
+uint32_t micros();
+
+void delay(uint32_t ms);
+
+void pinMode(uint32_t pin, uint32_t mode);
+
+int digitalRead(uint32_t pin);
+
+void digitalWrite(uint32_t pin, uint32_t value);
+
+// there are no interrupts on host
+inline void noInterrupts() {}
+
+inline void interrupts() {}
+
+class NativeSerial
+{
+public:
+    void begin(uint32_t baud){};
+
+    void println(const char *text)
+    {
+        std::puts(text);
+    }
+
+    template <typename... ARGS>
+    void printf(const char *format, ARGS... args)
+    {
+        std::printf(format, args...);
+    }
+};
+
+extern NativeSerial Serial;
@@ -0,0 +1,194 @@
+/*********************************************************************
+ * Railcom Decoder Native
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+#include "FeedbackDecoder/RailcomDecoder.h"
+#include "RailcomLegacyDecoder.h"
+#include <cstdio>
+#include <vector>
+
+// Railcom decoder without hardware access. replay() plays the ADC: it answers the DMA
+// requests of the decoder by filling m_railcomCaptures and the current sense buffer,
+// calls the ADC callbacks and runs cyclic() like ThreadCyclic.
+//
+// Trace format, one record per line:
+// # comment
+// S <portsPerCapture> <samplePeriodINus>  capture mode of next capture, default is 1 1
+// T <port> <voltageOffset> <trackSetVoltage> <N|L|A|l|a> <dccAddress> <numberOfSamples> <samples ...>
+//   L and A: loco or accessory packet is decoded before channel 1 is analyzed
+//   l and a: packet is decoded after channel 1 was analyzed
+// E <locoAddress> <direction> [port]  expectation for first port of previous capture or given port
+// D <type> <value1> <value2> [port]  accessory data event which is sent during analysis of previous capture
+// X <type> [port]                    no accessory data event of type is sent during analysis of previous capture
+// N <locoAddress> [port]             loco is not reported for first port of previous capture or given port
+class RailcomDecoderNative : public RailcomDecoder
+{
+public:
+    typedef struct
+    {
+        uint8_t port;
+        uint16_t voltageOffset;
+        uint16_t trackSetVoltage;
+        char addressType;
+        uint16_t address;
+        uint8_t portsPerCapture;
+        uint8_t samplePeriodINus;
+        // samples of ports are interleaved
+        std::vector<uint16_t> samples;
+    } Capture;
+
+    typedef struct
+    {
+        size_t channel1Bytes;
+        size_t channel2Bytes;
+        size_t framingErrors;
+        bool earlyRelease; // adc released after channel 1
+        bool captured;     // decoder selected port of capture within m_maxPacketsPerCapture packets
+    } CaptureResult;
+
+    typedef struct
+    {
+        // sliced samples, edges or bytes which differ between packed and legacy bit stream
+        size_t mismatches;
+        double packedINns;
+        double legacyINns;
+    } LegacyComparison;
+
+    RailcomDecoderNative(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, std::array<int, 8> &trackPin, uint8_t &statusLed,
+                         void (*printFunc)(const char *, ...) = nullptr, bool railcomDebug = false);
+    virtual ~RailcomDecoderNative() override;
+
+    // layout of port before begin(), occupied ports of a trace draw a current of m_occupiedCurrentINmA
+    void configTrack(uint8_t port, uint16_t voltageOffset, uint16_t trackSetVoltage);
+
+    // dcc packets are received until the decoder captures port of capture, cutouts of other ports are idle
+    CaptureResult replay(Capture &capture);
+
+    // average time of bit stream analysis of capture in ns
+    double benchmark(Capture &capture, size_t repetitions);
+
+    // slices capture with packed and legacy bit stream at trackSetVoltage and compares edges and bytes of both channels,
+    // returns false if capture is not a single port sampled each 1us like the legacy decoder expects
+    bool compareLegacy(Capture &capture, size_t repetitions, LegacyComparison &comparison);
+
+    bool isLocoInBlock(uint8_t port, uint16_t address, uint16_t direction);
+
+    // addresses which are currently reported for port
+    std::vector<uint16_t> getLocosInBlock(uint8_t port);
+
+    // observations of id 1 and id 2 of channel 1 before an address is reported
+    void configVoting(uint8_t threshold) { configChannel1Voting(threshold, m_channel1MaxHits); }
+
+    void printBlock(FILE *file, uint8_t port);
+
+    // decode statistics of port like they are requested by object config tags
+    void printStatistics(FILE *file, uint8_t port);
+
+    size_t getNumberOfCanMessages() { return m_numberOfCanMessages; }
+
+    // accessory data events of last replay as port, type, value1 and value2
+    const std::vector<std::array<uint16_t, 4>> &getAccessoryData() { return m_accessoryData; }
+
+    // average time to parse channel 2 of capture into datagrams in ns, number of datagrams is returned in numberOfDatagrams
+    double benchmarkChannel2(Capture &capture, size_t repetitions, size_t &numberOfDatagrams);
+
+    // returns 4 of 8 code of a 6 bit value or control code
+    static uint8_t encode4to8Code(uint8_t value);
+
+    // write synthetic captures including expectations
+    static void generateTrace(FILE *file);
+
+    static void writeCapture(FILE *file, Capture &capture);
+
+    // expectation is address, direction and port, data expectation is port, type, value1 and value2, absent data is port and type,
+    // absent loco is address and port
+    static bool readTrace(FILE *file, std::vector<Capture> &captures, std::vector<std::vector<std::array<uint16_t, 3>>> &expectations,
+                          std::vector<std::vector<std::array<uint16_t, 4>>> &dataExpectations,
+                          std::vector<std::vector<std::array<uint16_t, 2>>> &absentData,
+                          std::vector<std::vector<std::array<uint16_t, 2>>> &absentLocos);
+
+protected:
+    void configAdcSingleMode() override;
+
+    void configAdcDmaMode() override;
+
+    uint32_t singleAdcRead(int channel) override;
+
+    void triggerDmaRead(int channel, uint32_t *data, uint32_t length) override;
+
+    void triggerScanDmaRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length) override;
+
+    void triggerDualDmaRead(int channel1, int channel2, uint32_t *data, uint32_t length) override;
+
+    void triggerDualCurrentSenseRead(int channel1, int channel2, uint32_t *data, uint32_t length) override;
+
+    void stopDmaRead() override;
+
+    void triggerCircularScanRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length, bool transferInterrupts) override;
+
+    void armWatchdog(uint16_t lowThreshold, uint16_t highThreshold) override;
+
+    void disarmWatchdog() override;
+
+    void triggerInjectedRead(const int *channels, size_t numberOfChannels, uint16_t periodINus) override;
+
+    void setInjectedChannels(const int *channels) override;
+
+    uint16_t readInjectedValue(uint8_t rank) override;
+
+    // nanoseconds of host instead of cpu cycles
+    uint32_t readCycleCounter() override;
+
+    bool sendMessage(ZCanMessage &message) override;
+
+    // half and complete transfer of the running railcom capture, address of packet is received after channel 1 if it is late
+    void transferRailcomCapture(const Capture *capture);
+
+    void receiveAddress(const Capture &capture);
+
+    // cyclic() until captures are analyzed and current of every port was measured
+    void runIdleCycles();
+
+    // sum of start bits and of framing errors of ports of capture
+    std::array<uint32_t, 2> countStartBits(uint8_t port);
+
+    typedef struct
+    {
+        int channel;
+        uint16_t *data;
+        uint32_t length;
+        bool running;
+    } NativeDma;
+
+    NativeDma m_railcomDma{0, nullptr, 0, false};
+
+    NativeDma m_currentSenseDma{0, nullptr, 0, false};
+
+    std::array<bool, 8> m_portOccupied{};
+
+    const uint16_t m_occupiedCurrentINmA{20};
+
+    const size_t m_maxPacketsPerCapture{64};
+
+    const size_t m_maxIdleCycles{64};
+
+    size_t m_numberOfCanMessages{0};
+
+    RailcomLegacyDecoder m_legacyDecoder;
+
+    std::vector<std::array<uint16_t, 4>> m_accessoryData;
+};
@@ -0,0 +1,57 @@
+/*********************************************************************
+ * Railcom Legacy Decoder
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Bit stream analysis of RailcomDecoder before the samples were packed into words.
+// One bool per sample of a single port sampled each 1us. It is only kept on host,
+// so that the packed bit stream can be checked and benchmarked against it.
+class RailcomLegacyDecoder
+{
+public:
+    typedef struct
+    {
+        uint8_t data;
+        size_t startIndex;
+        size_t endIndex;
+    } LegacyByte;
+
+    typedef struct
+    {
+        size_t size;
+        std::array<LegacyByte, 8> bytes;
+    } LegacyChannelData;
+
+    // convert adc samples to logical uart levels, a sample is idle if |sample - offset| < trackSetVoltage
+    void handleBitStream(const uint16_t samples[], size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage);
+
+    // search for first negativ flank in [startIndex, endIndex) and returns true if complete byte fits in
+    bool getStartAndStopByteOfUart(size_t startIndex, size_t endIndex, size_t *findStartIndex, size_t *findEndIndex);
+
+    // valid 4 of 8 codes of [startOfSearch, endOfSearch)
+    void analyzeStream(LegacyChannelData &channel, size_t startOfSearch, size_t endOfSearch);
+
+    bool get(size_t index) const { return m_bitStream[index]; }
+
+    static constexpr size_t maxLength{512};
+
+private:
+    std::array<bool, maxLength> m_bitStream;
+};
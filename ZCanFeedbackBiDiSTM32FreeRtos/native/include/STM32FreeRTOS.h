@@ -0,0 +1,73 @@
+/*********************************************************************
+ * Native FreeRTOS
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#pragma once
+
+// Single threaded replacement of the FreeRTOS primitives used by the decoder
+
+#include <cstdint>
+
+typedef long BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+
+#define portEND_SWITCHING_ISR(xSwitchRequired) (void)(xSwitchRequired)
+
+typedef struct
+{
+    bool given;
+} NativeSemaphore;
+
+typedef NativeSemaphore *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return new NativeSemaphore{false};
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    (void)ticksToWait;
+    if (semaphore->given)
+    {
+        semaphore->given = false;
+        return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    if (semaphore->given)
+    {
+        return pdFALSE;
+    }
+    semaphore->given = true;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken)
+{
+    if (nullptr != higherPriorityTaskWoken)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
@@ -0,0 +1,50 @@
+/*********************************************************************
+ * Native Arduino
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#include "Arduino.h"
+
+uint32_t nativeTimeINms{0};
+
+NativeSerial Serial;
+
+uint32_t millis()
+{
+    return nativeTimeINms;
+}
+
+uint32_t micros()
+{
+    return nativeTimeINms * 1000;
+}
+
+void delay(uint32_t ms)
+{
+    nativeTimeINms += ms;
+}
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+}
+
+int digitalRead(uint32_t pin)
+{
+    // all configuration pins are pulled up
+    return HIGH;
+}
+
+void digitalWrite(uint32_t pin, uint32_t value)
+{
+}
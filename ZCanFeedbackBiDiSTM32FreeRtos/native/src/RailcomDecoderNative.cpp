@@ -0,0 +1,1104 @@
+/*********************************************************************
+ * Railcom Decoder Native
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#include "RailcomDecoderNative.h"
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+static bool saveDataNative()
+{
+    return true;
+}
+
+// bus without other nodes, messages of the decoder are counted by sendMessage()
+class NativeCanInterface : public CanInterface
+{
+public:
+    void begin() override{};
+
+    bool transmit(Can::Message &frame, uint16_t timeoutINms) override { return true; }
+
+    bool receive(Can::Message &frame, uint16_t timeoutINms) override { return false; }
+};
+
+RailcomDecoderNative::RailcomDecoderNative(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, std::array<int, 8> &trackPin, uint8_t &statusLed,
+                                           void (*printFunc)(const char *, ...), bool railcomDebug)
+    : RailcomDecoder(modulConfig, powerInfoConfig, saveDataNative, trackPin, PB12, PB13, statusLed, printFunc, false, false, railcomDebug)
+{
+    setCanObserver(std::make_shared<NativeCanInterface>());
+}
+
+RailcomDecoderNative::~RailcomDecoderNative()
+{
+}
+
+void RailcomDecoderNative::configAdcSingleMode()
+{
+}
+
+void RailcomDecoderNative::configAdcDmaMode()
+{
+}
+
+uint32_t RailcomDecoderNative::singleAdcRead(int channel)
+{
+    return 0;
+}
+
+void RailcomDecoderNative::triggerDmaRead(int channel, uint32_t *data, uint32_t length)
+{
+    // only current sense is read from a single channel
+    m_currentSenseDma = NativeDma{channel, reinterpret_cast<uint16_t *>(data), length, true};
+}
+
+void RailcomDecoderNative::triggerScanDmaRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length)
+{
+    m_railcomDma = NativeDma{channels[0], reinterpret_cast<uint16_t *>(data), length, true};
+}
+
+void RailcomDecoderNative::triggerDualDmaRead(int channel1, int channel2, uint32_t *data, uint32_t length)
+{
+    // two samples per transfer
+    m_railcomDma = NativeDma{channel1, reinterpret_cast<uint16_t *>(data), 2 * length, true};
+}
+
+void RailcomDecoderNative::triggerDualCurrentSenseRead(int channel1, int channel2, uint32_t *data, uint32_t length)
+{
+    // samples of channel2 are answered like those of channel1
+    m_currentSenseDma = NativeDma{channel1, reinterpret_cast<uint16_t *>(data), 2 * length, true};
+}
+
+void RailcomDecoderNative::stopDmaRead()
+{
+    m_railcomDma.running = false;
+    m_currentSenseDma.running = false;
+}
+
+void RailcomDecoderNative::triggerCircularScanRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length, bool transferInterrupts)
+{
+}
+
+void RailcomDecoderNative::armWatchdog(uint16_t lowThreshold, uint16_t highThreshold)
+{
+}
+
+void RailcomDecoderNative::disarmWatchdog()
+{
+}
+
+void RailcomDecoderNative::triggerInjectedRead(const int *channels, size_t numberOfChannels, uint16_t periodINus)
+{
+}
+
+void RailcomDecoderNative::setInjectedChannels(const int *channels)
+{
+}
+
+uint16_t RailcomDecoderNative::readInjectedValue(uint8_t rank)
+{
+    return 0;
+}
+
+uint32_t RailcomDecoderNative::readCycleCounter()
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool RailcomDecoderNative::sendMessage(ZCanMessage &message)
+{
+    m_numberOfCanMessages++;
+    if ((static_cast<uint8_t>(Group::Accessory) == message.group) && (static_cast<uint8_t>(AccessoryCmd::Data) == message.command) &&
+        (static_cast<uint8_t>(Mode::Evt) == message.mode))
+    {
+        m_accessoryData.push_back({message.data[2], message.data[3], static_cast<uint16_t>(message.data[4] | (message.data[5] << 8)),
+                                   static_cast<uint16_t>(message.data[6] | (message.data[7] << 8))});
+    }
+    return true;
+}
+
+void RailcomDecoderNative::configTrack(uint8_t port, uint16_t voltageOffset, uint16_t trackSetVoltage)
+{
+    if (port < m_trackData.size())
+    {
+        m_modulConfig.voltageOffset[port] = voltageOffset;
+        setDefaultTrackConfig(m_modulConfig.trackConfig[port]);
+        m_modulConfig.trackConfig[port].trackSetCurrentINmA = trackSetVoltage / m_countsPerMilliAmpere;
+        m_modulConfig.trackConfigVersion = currentTrackConfigVersion;
+    }
+}
+
+RailcomDecoderNative::CaptureResult RailcomDecoderNative::replay(Capture &capture)
+{
+    CaptureResult result{0, 0, 0, false, false};
+    if ((capture.port >= m_trackData.size()) || capture.samples.empty())
+    {
+        return result;
+    }
+    configRailcomCapture(capture.portsPerCapture, capture.samplePeriodINus);
+    m_accessoryData.clear();
+    // only occupied ports are captured on a layout, current sense of decoder has to find them
+    for (uint8_t port = capture.port; (port < (capture.port + m_railcomPortsPerCapture)) && (port < m_trackData.size()); port++)
+    {
+        m_portOccupied[port] = true;
+    }
+    for (size_t packet = 0; (packet < m_maxPacketsPerCapture) && !result.captured; packet++)
+    {
+        callbackDccReceived();
+        if (!m_railcomDma.running)
+        {
+            // previous cutout is still analyzed
+            runIdleCycles();
+            continue;
+        }
+        RailcomCapture &railcomCapture{m_railcomCaptures[m_railcomCaptureIndex]};
+        result.captured = (capture.port == railcomCapture.port);
+        if (!result.captured)
+        {
+            // cutout of another port without railcom data
+            for (size_t i = 0; i < m_railcomCaptureLength; i++)
+            {
+                railcomCapture.samples[i] = m_modulConfig.voltageOffset[railcomCapture.port + (i % m_railcomPortsPerCapture)];
+            }
+            transferRailcomCapture(nullptr);
+            runIdleCycles();
+            continue;
+        }
+        for (size_t i = 0; i < m_railcomCaptureLength; i++)
+        {
+            railcomCapture.samples[i] = (i < capture.samples.size()) ? capture.samples[i] : capture.voltageOffset;
+        }
+        std::array<uint32_t, 2> startBits{countStartBits(capture.port)};
+        transferRailcomCapture(&capture);
+        std::array<uint32_t, 2> endBits{countStartBits(capture.port)};
+        result.channel1Bytes = (endBits[0] - endBits[1]) - (startBits[0] - startBits[1]);
+        result.framingErrors = endBits[1] - startBits[1];
+        // adc is stopped after channel 1 if there is no channel 2
+        result.earlyRelease = !m_railcomDma.running;
+        startBits = endBits;
+        runIdleCycles();
+        endBits = countStartBits(capture.port);
+        result.channel2Bytes = (endBits[0] - endBits[1]) - (startBits[0] - startBits[1]);
+        result.framingErrors += endBits[1] - startBits[1];
+    }
+    return result;
+}
+
+void RailcomDecoderNative::transferRailcomCapture(const Capture *capture)
+{
+    bool lateAddress{(nullptr != capture) && (0 != std::islower(capture->addressType))};
+    if ((nullptr != capture) && !lateAddress)
+    {
+        receiveAddress(*capture);
+    }
+    callbackAdcReadHalfFinished(nullptr);
+    cyclic();
+    if (lateAddress)
+    {
+        receiveAddress(*capture);
+    }
+}
+
+void RailcomDecoderNative::receiveAddress(const Capture &capture)
+{
+    switch (std::toupper(capture.addressType))
+    {
+    case 'L':
+        callbackLocoAddrReceived(capture.address);
+        break;
+    case 'A':
+        callbackAccAddrReceived(capture.address);
+        break;
+    default:
+        break;
+    }
+}
+
+void RailcomDecoderNative::runIdleCycles()
+{
+    for (size_t i = 0; i < m_maxIdleCycles; i++)
+    {
+        if (m_railcomDma.running)
+        {
+            // complete transfer of channel 2
+            m_railcomDma.running = false;
+            callbackAdcReadFinished(nullptr);
+        }
+        else if (m_currentSenseDma.running)
+        {
+            uint8_t port{0};
+            while ((port < m_trackData.size()) && (m_trackData[port].pin != m_currentSenseDma.channel))
+            {
+                port++;
+            }
+            const uint16_t voltageOffset{(port < m_trackData.size()) ? m_modulConfig.voltageOffset[port] : static_cast<uint16_t>(0)};
+            const int32_t deviation{((port < m_trackData.size()) && m_portOccupied[port]) ? m_occupiedCurrentINmA * m_countsPerMilliAmpere : 0};
+            // current of dcc signal changes its sign with every half bit
+            for (uint32_t sample = 0; sample < m_currentSenseDma.length; sample++)
+            {
+                m_currentSenseDma.data[sample] = static_cast<uint16_t>(voltageOffset + ((0 == (sample & 1)) ? deviation : -deviation));
+            }
+            m_currentSenseDma.running = false;
+            callbackAdcReadFinished(nullptr);
+        }
+        else
+        {
+            bool captureRunning{false};
+            for (RailcomCapture &capture : m_railcomCaptures)
+            {
+                captureRunning |= (CaptureState::eFree != capture.state);
+            }
+            // pending telemetry of all locos is sent by repeated calls, like between dcc packets
+            if (!captureRunning && !m_currentSenseRunning && (i >= m_locoTelemetry.size()))
+            {
+                break;
+            }
+        }
+        cyclic();
+    }
+}
+
+std::array<uint32_t, 2> RailcomDecoderNative::countStartBits(uint8_t port)
+{
+    std::array<uint32_t, 2> count{0, 0};
+    for (uint8_t capturePort = port; (capturePort < (port + m_railcomPortsPerCapture)) && (capturePort < m_railcomStatistics.size()); capturePort++)
+    {
+        count[0] += m_railcomStatistics[capturePort].startBits;
+        count[1] += m_railcomStatistics[capturePort].invalidSymbols;
+    }
+    return count;
+}
+
+double RailcomDecoderNative::benchmark(Capture &capture, size_t repetitions)
+{
+    if (capture.samples.empty() || (0 == repetitions))
+    {
+        return 0.0;
+    }
+    configRailcomCapture(capture.portsPerCapture, capture.samplePeriodINus);
+    size_t length{capture.samples.size() / m_railcomPortsPerCapture};
+    length = length > BitStream::wordSize * 32 ? BitStream::wordSize * 32 : length;
+    size_t halfLength{length / 2};
+    size_t endOfChannel1{(halfLength - 1) > m_railcomTiming.endOfChannel1 ? m_railcomTiming.endOfChannel1 : halfLength - 1};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        for (uint8_t capturePort = 0; capturePort < m_railcomPortsPerCapture; capturePort++)
+        {
+            RailcomChannelData channel1;
+            RailcomChannelData channel2;
+            selectRailcomCapturePort(capture.samples.data(), capture.port, capturePort);
+            handleBitStream(0, halfLength, capture.voltageOffset, capture.trackSetVoltage);
+            analyzeStream(channel1, m_railcomTiming.startChannel1, endOfChannel1, capture.voltageOffset);
+            size_t numberOfDatagrams{0};
+            if (hasChannel2Data(halfLength))
+            {
+                std::array<Channel2Datagram, maxChannel2Datagrams> datagrams;
+                handleBitStream(halfLength, length, capture.voltageOffset, capture.trackSetVoltage);
+                analyzeStream(channel2, m_railcomTiming.startChannel2, length - 1, capture.voltageOffset);
+                numberOfDatagrams = parseChannel2(channel2, datagrams, channel2Formats);
+            }
+            // keep compiler from removing the analysis
+            asm volatile("" : : "r"(channel1.size + channel2.size + numberOfDatagrams) : "memory");
+        }
+    }
+    auto duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return duration.count() / repetitions;
+}
+
+double RailcomDecoderNative::benchmarkChannel2(Capture &capture, size_t repetitions, size_t &numberOfDatagrams)
+{
+    numberOfDatagrams = 0;
+    if (capture.samples.empty() || (0 == repetitions))
+    {
+        return 0.0;
+    }
+    configRailcomCapture(capture.portsPerCapture, capture.samplePeriodINus);
+    size_t length{capture.samples.size() / m_railcomPortsPerCapture};
+    length = length > BitStream::wordSize * 32 ? BitStream::wordSize * 32 : length;
+    std::array<RailcomChannelData, maxPortsPerCapture> channel2;
+    for (uint8_t capturePort = 0; capturePort < m_railcomPortsPerCapture; capturePort++)
+    {
+        selectRailcomCapturePort(capture.samples.data(), capture.port, capturePort);
+        handleBitStream(0, length, capture.voltageOffset, capture.trackSetVoltage);
+        analyzeStream(channel2[capturePort], m_railcomTiming.startChannel2, length - 1, capture.voltageOffset);
+    }
+    std::array<Channel2Datagram, maxChannel2Datagrams> datagrams;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        for (uint8_t capturePort = 0; capturePort < m_railcomPortsPerCapture; capturePort++)
+        {
+            size_t found{parseChannel2(channel2[capturePort], datagrams, channel2Formats)};
+            asm volatile("" : : "r"(found), "r"(datagrams.data()) : "memory");
+            numberOfDatagrams = (0 == i) ? (numberOfDatagrams + found) : numberOfDatagrams;
+        }
+    }
+    auto duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return duration.count() / repetitions;
+}
+
+bool RailcomDecoderNative::compareLegacy(Capture &capture, size_t repetitions, LegacyComparison &comparison)
+{
+    comparison = LegacyComparison{0, 0.0, 0.0};
+    if (capture.samples.empty() || (1 != capture.portsPerCapture) || (1 != capture.samplePeriodINus))
+    {
+        return false;
+    }
+    configRailcomCapture(capture.portsPerCapture, capture.samplePeriodINus);
+    size_t length{capture.samples.size()};
+    length = length > BitStream::wordSize * 32 ? BitStream::wordSize * 32 : length;
+    size_t endOfChannel1{(length - 1) > m_railcomTiming.endOfChannel1 ? m_railcomTiming.endOfChannel1 : length - 1};
+    const uint16_t *samples{capture.samples.data()};
+    selectRailcomCapturePort(capture.samples.data(), capture.port, 0);
+
+    // same threshold for both, slicing threshold of the cutout is not known to the legacy decoder
+    m_bitStream[0].slice(samples, 0, length, capture.voltageOffset, capture.trackSetVoltage);
+    m_legacyDecoder.handleBitStream(samples, length, capture.voltageOffset, capture.trackSetVoltage);
+    for (size_t index = 0; index < length; index++)
+    {
+        comparison.mismatches += (m_bitStream[0].get(index) != m_legacyDecoder.get(index)) ? 1 : 0;
+    }
+    const std::array<std::array<size_t, 2>, 2> windows{{{m_railcomTiming.startChannel1, endOfChannel1},
+                                                        {m_railcomTiming.startChannel2, length - 1}}};
+    for (auto &window : windows)
+    {
+        RailcomChannelData packed;
+        RailcomLegacyDecoder::LegacyChannelData legacy;
+        analyzeStream(packed, window[0], window[1], capture.voltageOffset);
+        m_legacyDecoder.analyzeStream(legacy, window[0], window[1]);
+        comparison.mismatches += (packed.size != legacy.size) ? 1 : 0;
+        for (size_t i = 0; (i < packed.size) && (i < legacy.size); i++)
+        {
+            comparison.mismatches += ((packed.bytes[i].data != legacy.bytes[i].data) || (packed.bytes[i].startIndex != legacy.bytes[i].startIndex) ||
+                                      (packed.bytes[i].endIndex != legacy.bytes[i].endIndex))
+                                         ? 1
+                                         : 0;
+        }
+    }
+    if (0 == repetitions)
+    {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        RailcomChannelData channel1;
+        RailcomChannelData channel2;
+        m_bitStream[0].slice(samples, 0, length, capture.voltageOffset, capture.trackSetVoltage);
+        analyzeStream(channel1, m_railcomTiming.startChannel1, endOfChannel1, capture.voltageOffset);
+        analyzeStream(channel2, m_railcomTiming.startChannel2, length - 1, capture.voltageOffset);
+        // keep compiler from removing the analysis
+        asm volatile("" : : "r"(channel1.size + channel2.size) : "memory");
+    }
+    comparison.packedINns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        RailcomLegacyDecoder::LegacyChannelData channel1;
+        RailcomLegacyDecoder::LegacyChannelData channel2;
+        m_legacyDecoder.handleBitStream(samples, length, capture.voltageOffset, capture.trackSetVoltage);
+        m_legacyDecoder.analyzeStream(channel1, m_railcomTiming.startChannel1, endOfChannel1);
+        m_legacyDecoder.analyzeStream(channel2, m_railcomTiming.startChannel2, length - 1);
+        asm volatile("" : : "r"(channel1.size + channel2.size) : "memory");
+    }
+    comparison.legacyINns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repetitions;
+    return true;
+}
+
+uint8_t RailcomDecoderNative::encode4to8Code(uint8_t value)
+{
+    return (value < RailcomCodec::numberOfCodes) ? RailcomCodec::encode4to8[value] : 0;
+}
+
+bool RailcomDecoderNative::isLocoInBlock(uint8_t port, uint16_t address, uint16_t direction)
+{
+    if (port < m_railcomData.size())
+    {
+        for (auto &data : m_railcomData[port].railcomAddr)
+        {
+            if ((address == data.address) && (direction == data.direction))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<uint16_t> RailcomDecoderNative::getLocosInBlock(uint8_t port)
+{
+    std::vector<uint16_t> locos;
+    if (port < m_railcomData.size())
+    {
+        for (auto &data : m_railcomData[port].railcomAddr)
+        {
+            if (0 != data.address)
+            {
+                locos.push_back(data.address);
+            }
+        }
+    }
+    return locos;
+}
+
+void RailcomDecoderNative::printBlock(FILE *file, uint8_t port)
+{
+    if (port < m_railcomData.size())
+    {
+        for (auto &data : m_railcomData[port].railcomAddr)
+        {
+            if (0 != data.address)
+            {
+                std::fprintf(file, " %u/0x%X", data.address, data.direction);
+            }
+        }
+    }
+}
+
+void RailcomDecoderNative::printStatistics(FILE *file, uint8_t port)
+{
+    std::fprintf(file, "port %u: cutouts %u, start bits %u, invalid symbols %u, channel 1 addresses %u, ack %u, nack %u, max analysis %u ns\n", port,
+                 getRailcomStatistic(port, 0), getRailcomStatistic(port, 1), getRailcomStatistic(port, 2), getRailcomStatistic(port, 3),
+                 getRailcomStatistic(port, 4), getRailcomStatistic(port, 5), getRailcomStatistic(port, 7));
+}
+
+void RailcomDecoderNative::writeCapture(FILE *file, Capture &capture)
+{
+    if ((1 != capture.portsPerCapture) || (1 != capture.samplePeriodINus))
+    {
+        std::fprintf(file, "S %u %u\n", capture.portsPerCapture, capture.samplePeriodINus);
+    }
+    std::fprintf(file, "T %u %u %u %c %u %zu", capture.port, capture.voltageOffset, capture.trackSetVoltage, capture.addressType, capture.address, capture.samples.size());
+    for (uint16_t sample : capture.samples)
+    {
+        std::fprintf(file, " %u", sample);
+    }
+    std::fprintf(file, "\n");
+}
+
+bool RailcomDecoderNative::readTrace(FILE *file, std::vector<Capture> &captures, std::vector<std::vector<std::array<uint16_t, 3>>> &expectations,
+                                     std::vector<std::vector<std::array<uint16_t, 4>>> &dataExpectations,
+                                     std::vector<std::vector<std::array<uint16_t, 2>>> &absentData,
+                                     std::vector<std::vector<std::array<uint16_t, 2>>> &absentLocos)
+{
+    unsigned portsPerCapture{1};
+    unsigned samplePeriodINus{1};
+    char record[2];
+    while (1 == std::fscanf(file, " %1s", record))
+    {
+        if ('#' == record[0])
+        {
+            int character;
+            do
+            {
+                character = std::fgetc(file);
+            } while ((EOF != character) && ('\n' != character));
+        }
+        else if ('S' == record[0])
+        {
+            if (2 != std::fscanf(file, "%u %u", &portsPerCapture, &samplePeriodINus))
+            {
+                return false;
+            }
+        }
+        else if ('T' == record[0])
+        {
+            Capture capture;
+            unsigned port, voltageOffset, trackSetVoltage, address;
+            char addressType;
+            size_t numberOfSamples;
+            if (6 != std::fscanf(file, "%u %u %u %c %u %zu", &port, &voltageOffset, &trackSetVoltage, &addressType, &address, &numberOfSamples))
+            {
+                return false;
+            }
+            capture.port = port;
+            capture.voltageOffset = voltageOffset;
+            capture.trackSetVoltage = trackSetVoltage;
+            capture.addressType = addressType;
+            capture.address = address;
+            capture.portsPerCapture = portsPerCapture;
+            capture.samplePeriodINus = samplePeriodINus;
+            portsPerCapture = 1;
+            samplePeriodINus = 1;
+            capture.samples.resize(numberOfSamples);
+            for (uint16_t &sample : capture.samples)
+            {
+                unsigned value;
+                if (1 != std::fscanf(file, "%u", &value))
+                {
+                    return false;
+                }
+                sample = value;
+            }
+            captures.push_back(capture);
+            expectations.emplace_back();
+            dataExpectations.emplace_back();
+            absentData.emplace_back();
+            absentLocos.emplace_back();
+        }
+        else if ('E' == record[0])
+        {
+            char line[64];
+            unsigned address;
+            int direction;
+            unsigned port;
+            if ((nullptr == std::fgets(line, sizeof(line), file)) || captures.empty())
+            {
+                return false;
+            }
+            int numberOfValues = std::sscanf(line, "%u %i %u", &address, &direction, &port);
+            if (numberOfValues < 2)
+            {
+                return false;
+            }
+            if (numberOfValues < 3)
+            {
+                port = captures.back().port;
+            }
+            expectations.back().push_back({static_cast<uint16_t>(address), static_cast<uint16_t>(direction), static_cast<uint16_t>(port)});
+        }
+        else if ('D' == record[0])
+        {
+            char line[64];
+            unsigned type, value1, value2, port;
+            if ((nullptr == std::fgets(line, sizeof(line), file)) || captures.empty())
+            {
+                return false;
+            }
+            int numberOfValues = std::sscanf(line, "%i %i %i %u", &type, &value1, &value2, &port);
+            if (numberOfValues < 3)
+            {
+                return false;
+            }
+            if (numberOfValues < 4)
+            {
+                port = captures.back().port;
+            }
+            dataExpectations.back().push_back({static_cast<uint16_t>(port), static_cast<uint16_t>(type), static_cast<uint16_t>(value1), static_cast<uint16_t>(value2)});
+        }
+        else if ('X' == record[0])
+        {
+            char line[64];
+            unsigned type, port;
+            if ((nullptr == std::fgets(line, sizeof(line), file)) || captures.empty())
+            {
+                return false;
+            }
+            int numberOfValues = std::sscanf(line, "%i %u", &type, &port);
+            if (numberOfValues < 1)
+            {
+                return false;
+            }
+            if (numberOfValues < 2)
+            {
+                port = captures.back().port;
+            }
+            absentData.back().push_back({static_cast<uint16_t>(port), static_cast<uint16_t>(type)});
+        }
+        else if ('N' == record[0])
+        {
+            char line[64];
+            unsigned address, port;
+            if ((nullptr == std::fgets(line, sizeof(line), file)) || captures.empty())
+            {
+                return false;
+            }
+            int numberOfValues = std::sscanf(line, "%u %u", &address, &port);
+            if (numberOfValues < 1)
+            {
+                return false;
+            }
+            if (numberOfValues < 2)
+            {
+                port = captures.back().port;
+            }
+            absentLocos.back().push_back({static_cast<uint16_t>(address), static_cast<uint16_t>(port)});
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// synthetic trace generation
+
+namespace
+{
+    const uint16_t generatorOffset{2048};
+    // 10 mA * 18
+    const uint16_t generatorSetVoltage{180};
+    // roughly 30 mA railcom current
+    const uint16_t generatorAmplitude{540};
+    const size_t generatorLength{400};
+    const size_t generatorStartChannel1{40};
+    const size_t generatorStartChannel2{165};
+
+    class CaptureSignal
+    {
+    public:
+        CaptureSignal(uint8_t port, char addressType, uint16_t address, std::mt19937 &random, double noise = 0.0)
+            : m_random(random), m_noise(noise)
+        {
+            m_capture.port = port;
+            m_capture.voltageOffset = generatorOffset;
+            m_capture.trackSetVoltage = generatorSetVoltage;
+            m_capture.addressType = addressType;
+            m_capture.address = address;
+            m_capture.portsPerCapture = 1;
+            m_capture.samplePeriodINus = 1;
+            m_level.assign(generatorLength, 0);
+        }
+
+        // uart byte with start bit, 8 data bits lsb first and stop bit, 4 samples per bit
+        size_t addByte(size_t startIndex, uint8_t code, int direction)
+        {
+            for (size_t bit = 0; bit < 10; bit++)
+            {
+                bool zero = (0 == bit) || ((bit < 9) && (0 == (code & (1 << (bit - 1)))));
+                for (size_t sample = 0; sample < 4; sample++)
+                {
+                    size_t index = startIndex + bit * 4 + sample;
+                    if (zero && (index < m_level.size()))
+                    {
+                        m_level[index] = direction;
+                    }
+                }
+            }
+            return startIndex + 40;
+        }
+
+        // railcom current of zero bits, default is roughly 30 mA
+        void setAmplitude(uint16_t amplitude)
+        {
+            m_amplitude = amplitude;
+        }
+
+        // single sample with inverted uart level
+        void addSpike(size_t index, int direction)
+        {
+            if (index < m_level.size())
+            {
+                m_spikes.push_back({index, direction});
+            }
+        }
+
+        // single sample with railcom current of direction independent of uart level
+        void addGlitch(size_t index, int direction)
+        {
+            if (index < m_level.size())
+            {
+                m_glitches.push_back({index, direction});
+            }
+        }
+
+        RailcomDecoderNative::Capture &capture()
+        {
+            std::normal_distribution<double> noise(0.0, m_noise > 0.0 ? m_noise : 1.0);
+            m_capture.samples.resize(m_level.size());
+            for (size_t i = 0; i < m_level.size(); i++)
+            {
+                int value = generatorOffset + m_level[i] * m_amplitude;
+                if (m_noise > 0.0)
+                {
+                    value += static_cast<int>(noise(m_random));
+                }
+                m_capture.samples[i] = static_cast<uint16_t>(value);
+            }
+            for (auto &spike : m_spikes)
+            {
+                int level = (0 == m_level[spike.first]) ? spike.second : 0;
+                m_capture.samples[spike.first] = static_cast<uint16_t>(generatorOffset + level * m_amplitude);
+            }
+            for (auto &glitch : m_glitches)
+            {
+                m_capture.samples[glitch.first] = static_cast<uint16_t>(generatorOffset + glitch.second * m_amplitude);
+            }
+            return m_capture;
+        }
+
+    private:
+        std::mt19937 &m_random;
+        double m_noise;
+        uint16_t m_amplitude{generatorAmplitude};
+        std::vector<int> m_level;
+        std::vector<std::pair<size_t, int>> m_spikes;
+        std::vector<std::pair<size_t, int>> m_glitches;
+        RailcomDecoderNative::Capture m_capture;
+    };
+}
+
+static size_t addDatagram12Bit(CaptureSignal &signal, size_t startIndex, uint8_t id, uint8_t value, int direction)
+{
+    startIndex = signal.addByte(startIndex, RailcomDecoderNative::encode4to8Code(((id & 0x0F) << 2) | (value >> 6)), direction);
+    return signal.addByte(startIndex, RailcomDecoderNative::encode4to8Code(value & 0x3F), direction);
+}
+
+// datagram of channel 2 with numberOfSymbols 6 bit symbols, first received bits of value are MSB
+static size_t addDatagram(CaptureSignal &signal, size_t startIndex, uint8_t id, uint32_t value, uint8_t numberOfSymbols, int direction)
+{
+    uint64_t bits{(static_cast<uint64_t>(id & 0x0F) << ((numberOfSymbols * 6) - 4)) | value};
+    for (int symbol = numberOfSymbols - 1; symbol >= 0; symbol--)
+    {
+        startIndex = signal.addByte(startIndex, RailcomDecoderNative::encode4to8Code((bits >> (symbol * 6)) & 0x3F), direction);
+    }
+    return startIndex;
+}
+
+// scan mode of adc samples port i at odd or even us, dual mode samples both ports at the same time
+static RailcomDecoderNative::Capture interleaveCaptures(std::vector<RailcomDecoderNative::Capture> &portCaptures, bool dualMode)
+{
+    RailcomDecoderNative::Capture capture = portCaptures.front();
+    size_t numberOfPorts{portCaptures.size()};
+    capture.portsPerCapture = static_cast<uint8_t>(numberOfPorts);
+    capture.samplePeriodINus = static_cast<uint8_t>(dualMode ? 1 : numberOfPorts);
+    size_t samplesPerPort{generatorLength / capture.samplePeriodINus};
+    capture.samples.resize(samplesPerPort * numberOfPorts);
+    for (size_t sample = 0; sample < samplesPerPort; sample++)
+    {
+        for (size_t port = 0; port < numberOfPorts; port++)
+        {
+            size_t timeINus{sample * capture.samplePeriodINus + (dualMode ? 0 : port)};
+            capture.samples[sample * numberOfPorts + port] = portCaptures[port].samples[timeINus];
+        }
+    }
+    return capture;
+}
+
+// decimation mode of adc samples a single port each 2us, phase is the time of the first sample
+static RailcomDecoderNative::Capture decimateCapture(const RailcomDecoderNative::Capture &portCapture, size_t phaseINus)
+{
+    RailcomDecoderNative::Capture capture = portCapture;
+    capture.samplePeriodINus = 2;
+    capture.samples.clear();
+    for (size_t timeINus = phaseINus; timeINus < portCapture.samples.size(); timeINus += capture.samplePeriodINus)
+    {
+        capture.samples.push_back(portCapture.samples[timeINus]);
+    }
+    return capture;
+}
+
+static void addChannel1Address(std::vector<RailcomDecoderNative::Capture> &captures, uint8_t port, uint16_t locoAddr, int direction,
+                               std::mt19937 &random, double noise, char addressType = 'N', uint16_t dccAddress = 0)
+{
+    uint8_t addressHigh = locoAddr > 127 ? static_cast<uint8_t>(0x80 | ((locoAddr >> 8) & 0x3F)) : 0;
+    uint8_t addressLow = static_cast<uint8_t>(locoAddr & 0xFF);
+    CaptureSignal first(port, addressType, dccAddress, random, noise);
+    addDatagram12Bit(first, generatorStartChannel1, 1, addressHigh, direction);
+    captures.push_back(first.capture());
+    CaptureSignal second(port, addressType, dccAddress, random, noise);
+    addDatagram12Bit(second, generatorStartChannel1 + 2, 2, addressLow, direction);
+    captures.push_back(second.capture());
+}
+
+void RailcomDecoderNative::generateTrace(FILE *file)
+{
+    std::mt19937 random(0x10808);
+    std::vector<Capture> captures;
+
+    std::fprintf(file, "# synthetic railcom captures, 1 sample per us, offset %u, set voltage %u, railcom amplitude %u\n",
+                 generatorOffset, generatorSetVoltage, generatorAmplitude);
+
+    std::fprintf(file, "# channel 1: short address 3, forward, port 0\n");
+    addChannel1Address(captures, 0, 3, 1, random, 8.0);
+    for (auto &capture : captures)
+    {
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 3 0x10\n");
+    captures.clear();
+
+    std::fprintf(file, "# channel 1: long address 1234, reverse, port 1\n");
+    addChannel1Address(captures, 1, 1234, -1, random, 8.0);
+    for (auto &capture : captures)
+    {
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 1234 0x11\n");
+    captures.clear();
+
+    std::fprintf(file, "# channel 2: ACK of loco 55, forward, port 2\n");
+    {
+        CaptureSignal signal(2, 'L', 55, random, 8.0);
+        signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 55 0x10\n");
+    }
+
+    std::fprintf(file, "# channel 2: NACK of loco 9000, reverse, port 2\n");
+    {
+        CaptureSignal signal(2, 'L', 9000, random, 8.0);
+        signal.addByte(generatorStartChannel2 + 3, RailcomDecoderNative::encode4to8Code(0x40), -1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 9000 0x11\n");
+    }
+
+    std::fprintf(file, "# channel 1 and 2: address 78 with POM answer and ACK, noisy, port 3\n");
+    for (uint8_t id = 1; id <= 2; id++)
+    {
+        CaptureSignal signal(3, 'L', 78, random, 40.0);
+        addDatagram12Bit(signal, generatorStartChannel1, id, (1 == id) ? 0 : 78, 1);
+        size_t index = addDatagram12Bit(signal, generatorStartChannel2, 0, 0x5A, 1);
+        signal.addByte(index, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "D 0x20 78 0x5A\n");
+    }
+    std::fprintf(file, "E 78 0x10\n");
+
+    std::fprintf(file, "# channel 1: spikes inside of data bits cause framing errors, address 4, reverse, port 4\n");
+    {
+        CaptureSignal signal(4, 'N', 0, random, 20.0);
+        addDatagram12Bit(signal, generatorStartChannel1, 1, 0, -1);
+        // samples in the middle of data bit 1 of both bytes
+        signal.addSpike(generatorStartChannel1 + 9, -1);
+        signal.addSpike(generatorStartChannel1 + 40 + 9, -1);
+        writeCapture(file, signal.capture());
+    }
+    addChannel1Address(captures, 4, 4, -1, random, 20.0);
+    for (auto &capture : captures)
+    {
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 4 0x11\n");
+    captures.clear();
+
+    std::fprintf(file, "# channel 2: answer of accessory decoder 12, port 5\n");
+    {
+        CaptureSignal signal(5, 'A', 12, random, 8.0);
+        signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        writeCapture(file, signal.capture());
+    }
+
+    std::fprintf(file, "# no railcom, noise only, port 6\n");
+    {
+        CaptureSignal signal(6, 'L', 3, random, 60.0);
+        writeCapture(file, signal.capture());
+    }
+
+    std::fprintf(file, "# scan mode: address 3 forward on port 6 and address 1234 reverse on port 7 in the same cutouts\n");
+    for (uint8_t id = 1; id <= 2; id++)
+    {
+        std::vector<Capture> portCaptures;
+        CaptureSignal port6(6, 'N', 0, random, 8.0);
+        addDatagram12Bit(port6, generatorStartChannel1, id, (1 == id) ? 0 : 3, 1);
+        portCaptures.push_back(port6.capture());
+        CaptureSignal port7(7, 'N', 0, random, 8.0);
+        addDatagram12Bit(port7, generatorStartChannel1 + 1, id, (1 == id) ? (0x80 | (1234 >> 8)) : (1234 & 0xFF), -1);
+        portCaptures.push_back(port7.capture());
+        Capture capture = interleaveCaptures(portCaptures, false);
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 3 0x10 6\n");
+    std::fprintf(file, "E 1234 0x11 7\n");
+
+    std::fprintf(file, "# scan mode: ACK of loco 300 reverse on port 7, port 6 without railcom\n");
+    {
+        std::vector<Capture> portCaptures;
+        CaptureSignal port6(6, 'L', 300, random, 8.0);
+        portCaptures.push_back(port6.capture());
+        CaptureSignal port7(7, 'L', 300, random, 8.0);
+        port7.addByte(generatorStartChannel2 + 1, RailcomDecoderNative::encode4to8Code(0x41), -1);
+        portCaptures.push_back(port7.capture());
+        Capture capture = interleaveCaptures(portCaptures, false);
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 300 0x11 7\n");
+
+    std::fprintf(file, "# dual adc mode: address 3000 reverse on port 2 and ACK of loco 3000 forward on port 3\n");
+    for (uint8_t id = 1; id <= 2; id++)
+    {
+        std::vector<Capture> portCaptures;
+        CaptureSignal port2(2, 'L', 3000, random, 8.0);
+        addDatagram12Bit(port2, generatorStartChannel1 + 3, id, (1 == id) ? (0x80 | (3000 >> 8)) : (3000 & 0xFF), -1);
+        portCaptures.push_back(port2.capture());
+        CaptureSignal port3(3, 'L', 3000, random, 8.0);
+        port3.addByte(generatorStartChannel2 + 2, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        portCaptures.push_back(port3.capture());
+        Capture capture = interleaveCaptures(portCaptures, true);
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 3000 0x11 2\n");
+    std::fprintf(file, "E 3000 0x10 3\n");
+
+    std::fprintf(file, "# channel 1 with wrong value of id 1 after address is known: address 5000 forward, port 5, 5256 must not be reported\n");
+    {
+        const uint16_t locoAddr{5000};
+        const uint8_t addressHigh{static_cast<uint8_t>(0x80 | (locoAddr >> 8))};
+        const uint8_t addressLow{static_cast<uint8_t>(locoAddr & 0xFF)};
+        // id and value of every cutout, a value seen once without history can not be told from a wrong one
+        const std::array<std::pair<uint8_t, uint8_t>, 8> datagrams{{{2, addressLow}, {1, addressHigh}, {2, addressLow}, {1, addressHigh}, {2, addressLow}, {1, static_cast<uint8_t>(addressHigh + 1)}, {2, addressLow}, {1, addressHigh}}};
+        for (auto &datagram : datagrams)
+        {
+            CaptureSignal signal(5, 'N', 0, random, 20.0);
+            addDatagram12Bit(signal, generatorStartChannel1, datagram.first, datagram.second, 1);
+            writeCapture(file, signal.capture());
+        }
+        std::fprintf(file, "E 5000 0x10\n");
+    }
+
+    // six symbols of channel 2 need 240us, so they start directly at begin of search window
+    const size_t earlyStartChannel2{152};
+
+    std::fprintf(file, "# channel 2: DYN speed 42 km/h and DYN temperature 25 degree of loco 1234 as telemetry, reverse, port 1\n");
+    {
+        CaptureSignal signal(1, 'L', 1234, random, 8.0);
+        size_t index = addDatagram(signal, earlyStartChannel2, 7, (42 << 6) | 0, 3, -1);
+        addDatagram(signal, index, 7, (75 << 6) | 26, 3, -1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 1234 0x11\n");
+        std::fprintf(file, "D 0x25 1234 42\n");
+        std::fprintf(file, "D 0x27 1234 25\n");
+        std::fprintf(file, "X 0x22\n");
+    }
+
+    std::fprintf(file, "# channel 2: EXT location of loco 3, unknown id 5 is skipped, forward, port 0\n");
+    {
+        CaptureSignal signal(0, 'L', 3, random, 8.0);
+        size_t index = addDatagram(signal, generatorStartChannel2, 5, 0x12, 2, 1);
+        addDatagram(signal, index, 3, 0x1234, 3, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 3 0x10\n");
+        std::fprintf(file, "D 0x21 3 0x1234\n");
+    }
+
+    std::fprintf(file, "# channel 2: XPOM sequence 1 of loco 3000 with cv values 0x11 0x22 0x33 0x44, forward, port 2, single datagram keeps reverse\n");
+    std::fprintf(file, "# XPOM is only forwarded with RAILCOM_TIMER_TRIGGER, so its symbols are skipped\n");
+    {
+        CaptureSignal signal(2, 'L', 3000, random, 8.0);
+        addDatagram(signal, earlyStartChannel2, 9, 0x11223344, 6, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 3000 0x11\n");
+        std::fprintf(file, "X 0x23\n");
+        std::fprintf(file, "X 0x24\n");
+    }
+
+    std::fprintf(file, "# telemetry: speed of loco 4711 within deadband and within min interval of 100ms, forward, port 6\n");
+    {
+        CaptureSignal signal(6, 'L', 4711, random, 8.0);
+        size_t index = addDatagram(signal, earlyStartChannel2, 7, (100 << 6) | 0, 3, 1);
+        addDatagram(signal, index, 7, (3 << 6) | 7, 3, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "E 4711 0x10\n");
+        std::fprintf(file, "D 0x25 4711 100\n");
+        std::fprintf(file, "D 0x26 4711 3\n");
+    }
+    for (uint8_t speed : {101, 120})
+    {
+        CaptureSignal signal(6, 'L', 4711, random, 8.0);
+        addDatagram(signal, earlyStartChannel2, 7, (speed << 6) | 0, 3, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "X 0x25\n");
+    }
+    std::fprintf(file, "# telemetry: pending speed 120 of loco 4711 is sent 100ms after last report without new datagram\n");
+    for (int i = 0; i < 8; i++)
+    {
+        CaptureSignal signal(6, 'L', 4711, random, 8.0);
+        writeCapture(file, signal.capture());
+        if (i < 7)
+        {
+            std::fprintf(file, "X 0x25\n");
+        }
+    }
+    std::fprintf(file, "D 0x25 4711 120\n");
+
+    std::fprintf(file, "# channel 1: locos 10 and 20 enter port 1 of loco 1234, channel 1 of all collides, 10 and 20 are confirmed by channel 2\n");
+    for (int i = 0; i < 5; i++)
+    {
+        uint16_t address = (0 == (i % 2)) ? 10 : 20;
+        uint8_t id = (0 == (i % 2)) ? 1 : 2;
+        CaptureSignal signal(1, 'L', address, random, 8.0);
+        addDatagram12Bit(signal, generatorStartChannel1, id, (1 == id) ? (0x80 | (1234 >> 8)) : (1234 & 0xFF), -1);
+        for (uint8_t loco : {10, 20})
+        {
+            addDatagram12Bit(signal, generatorStartChannel1, id, (1 == id) ? 0 : loco, 1);
+        }
+        if (3 <= i)
+        {
+            signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), (10 == address) ? 1 : -1);
+        }
+        writeCapture(file, signal.capture());
+    }
+    std::fprintf(file, "E 10 0x10\n");
+    std::fprintf(file, "E 20 0x11\n");
+    std::fprintf(file, "E 1234 0x11\n");
+
+    std::fprintf(file, "# channel 1: srq of accessory 300 after packet to accessory 12 is no loco address, repetition is suppressed, port 4\n");
+    for (int i = 0; i < 2; i++)
+    {
+        CaptureSignal signal(4, 'A', 12, random, 8.0);
+        addDatagram(signal, generatorStartChannel1, 300 >> 8, 300 & 0xFF, 2, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, (0 == i) ? "D 0x34 300 0\n" : "X 0x34\n");
+    }
+
+    std::fprintf(file, "# channel 1: srq 0x105 and 0x20A look like id 1 and id 2 of loco 10, accessory packet is decoded after channel 1, port 4\n");
+    for (uint16_t srq : {0x105, 0x20A})
+    {
+        CaptureSignal signal(4, 'a', 12, random, 8.0);
+        addDatagram(signal, generatorStartChannel1, srq >> 8, srq & 0xFF, 2, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "D 0x34 0x%X 0\n", srq);
+        std::fprintf(file, "N 10\n");
+    }
+
+    std::fprintf(file, "# channel 2: STAT4 0x05 and ERROR 0x02 of accessory 12, port 4\n");
+    {
+        CaptureSignal signal(4, 'A', 12, random, 8.0);
+        size_t index = addDatagram(signal, generatorStartChannel2, 3, 0x05, 2, 1);
+        addDatagram(signal, index, 6, 0x02, 2, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, "D 0x30 12 0x05\n");
+        std::fprintf(file, "D 0x33 12 0x02\n");
+    }
+
+    std::fprintf(file, "# channel 1 and 2: weak decoder with 9 mA railcom current below set voltage, address 6 with ACK, forward, port 4\n");
+    for (uint8_t id = 1; id <= 2; id++)
+    {
+        CaptureSignal signal(4, 'L', 6, random, 8.0);
+        signal.setAmplitude(162);
+        addDatagram12Bit(signal, generatorStartChannel1, id, (1 == id) ? 0 : 6, 1);
+        signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        writeCapture(file, signal.capture());
+    }
+    std::fprintf(file, "E 6 0x10\n");
+
+    std::fprintf(file, "# channel 2: loco 3 turns to reverse, ACK with forward sample in a zero bit, direction changes after third ACK, port 0\n");
+    for (int i = 0; i < 3; i++)
+    {
+        CaptureSignal signal(0, 'L', 3, random, 8.0);
+        signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), -1);
+        signal.addGlitch(generatorStartChannel2 + 9, 1);
+        writeCapture(file, signal.capture());
+        std::fprintf(file, (2 == i) ? "E 3 0x11\n" : "E 3 0x10\n");
+    }
+
+    std::fprintf(file, "# decimation mode: address 7 forward with ACK on port 6, 2us per sample with both phases\n");
+    for (uint8_t id = 1; id <= 2; id++)
+    {
+        CaptureSignal signal(6, 'L', 7, random, 8.0);
+        addDatagram12Bit(signal, generatorStartChannel1, id, (1 == id) ? 0 : 7, 1);
+        signal.addByte(generatorStartChannel2, RailcomDecoderNative::encode4to8Code(0x41), 1);
+        Capture capture = decimateCapture(signal.capture(), id - 1);
+        writeCapture(file, capture);
+    }
+    std::fprintf(file, "E 7 0x10\n");
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Railcom Legacy Decoder
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+#include "RailcomLegacyDecoder.h"
+#include "FeedbackDecoder/Railcom/Codec.h"
+
+void RailcomLegacyDecoder::handleBitStream(const uint16_t samples[], size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage)
+{
+    auto iteratorBit = m_bitStream.begin();
+
+    size_t maxIterator{length > m_bitStream.size() ? m_bitStream.size() : length};
+
+    for (size_t i = 0; i < maxIterator; i++)
+    {
+        if (samples[i] > voltageOffset)
+        {
+            *iteratorBit = ((samples[i] - voltageOffset) < trackSetVoltage);
+        }
+        else
+        {
+            *iteratorBit = ((voltageOffset - samples[i]) < trackSetVoltage);
+        }
+        iteratorBit++;
+    }
+    // samples after length are zero like in the packed bit stream
+    for (; iteratorBit != m_bitStream.end(); iteratorBit++)
+    {
+        *iteratorBit = false;
+    }
+}
+
+bool RailcomLegacyDecoder::getStartAndStopByteOfUart(size_t startIndex, size_t endIndex, size_t *findStartIndex, size_t *findEndIndex)
+{
+    bool result{false};
+    // search for first high level
+    while (startIndex < endIndex)
+    {
+        if (m_bitStream[startIndex] && !m_bitStream[startIndex + 1])
+        {
+            // negativ flank found
+            *findStartIndex = startIndex;
+
+            *findEndIndex = *findStartIndex + 37;
+            if (*findEndIndex <= endIndex)
+            {
+                result = true;
+            }
+            break;
+        }
+        startIndex++;
+    }
+    return result;
+}
+
+void RailcomLegacyDecoder::analyzeStream(LegacyChannelData &channel, size_t startOfSearch, size_t endOfSearch)
+{
+    size_t startIndex{0};
+    size_t endIndex{0};
+    uint8_t numberOfBytes{0};
+
+    // number of bytes was not limited by the legacy decoder, it is limited like in the packed one
+    while ((numberOfBytes < channel.bytes.size()) && getStartAndStopByteOfUart(startOfSearch, endOfSearch, &startIndex, &endIndex))
+    {
+        // found
+        uint8_t dataByte{0};
+        uint8_t bit{0};
+        channel.bytes[numberOfBytes].startIndex = startIndex;
+        channel.bytes[numberOfBytes].endIndex = endIndex;
+        startIndex += 6; // add 6 bits to get to middle of first data bit
+        size_t endOfByte{startIndex + 28};
+        while (endOfByte >= startIndex)
+        {
+            dataByte |= ((m_bitStream[startIndex] ? 1 : 0) << bit++);
+            startIndex += 4;
+        }
+        // from 4 to 8 code, the table of the packed decoder is used, so that only the bit stream is compared
+        dataByte = RailcomCodec::encode8to4[dataByte];
+        switch (dataByte)
+        {
+        case RailcomCodec::unused:
+        case RailcomCodec::invalid:
+            // not used => error
+            break;
+        default:
+            channel.bytes[numberOfBytes].data = dataByte;
+            numberOfBytes++;
+            break;
+        }
+        startOfSearch = endIndex;
+    }
+    channel.size = numberOfBytes;
+}
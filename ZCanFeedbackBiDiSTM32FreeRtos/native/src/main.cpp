@@ -0,0 +1,316 @@
+/*********************************************************************
+ * Railcom replay
+ *
+ * Copyright (C) 2023 Marcel Maage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * LICENSE file for more details.
+ */
+
+// Replays recorded railcom captures through RailcomDecoder on a host.
+//
+// usage: program <trace> [repetitions] [-v] [-a threshold]   replay trace and benchmark every capture
+//        program --generate                                  write synthetic trace to stdout
+//
+// -a sets the number of observations of channel 1 before an address is reported.
+// Captures of a single port sampled each 1us are also sliced by the legacy bool bit stream,
+// every difference of edges or bytes to the packed bit stream fails like an expectation.
+// Returns 1 if a trace could not be read or an expectation failed.
+
+#include "Arduino.h"
+#include "RailcomDecoderNative.h"
+#include <cstdarg>
+#include <cstring>
+
+static bool verbose{false};
+
+static void printNative(const char *format, ...)
+{
+    if (!verbose)
+    {
+        return;
+    }
+    va_list arguments;
+    va_start(arguments, format);
+    std::vprintf(format, arguments);
+    va_end(arguments);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t dccPacketIntervalINms{10};
+    const char *traceName{nullptr};
+    size_t repetitions{1000};
+    unsigned threshold{RAILCOM_CHANNEL1_THRESHOLD};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == std::strcmp(argv[i], "--generate"))
+        {
+            RailcomDecoderNative::generateTrace(stdout);
+            return 0;
+        }
+        else if (0 == std::strcmp(argv[i], "-v"))
+        {
+            verbose = true;
+        }
+        else if ((0 == std::strcmp(argv[i], "-a")) && ((i + 1) < argc))
+        {
+            threshold = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (nullptr == traceName)
+        {
+            traceName = argv[i];
+        }
+        else
+        {
+            repetitions = std::strtoul(argv[i], nullptr, 10);
+        }
+    }
+    if (nullptr == traceName)
+    {
+        std::printf("usage: %s <trace> [repetitions] [-v] [-a threshold] | --generate\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = std::fopen(traceName, "r");
+    if (nullptr == file)
+    {
+        std::printf("Could not open %s\n", traceName);
+        return 1;
+    }
+    std::vector<RailcomDecoderNative::Capture> captures;
+    std::vector<std::vector<std::array<uint16_t, 3>>> expectations;
+    std::vector<std::vector<std::array<uint16_t, 4>>> dataExpectations;
+    std::vector<std::vector<std::array<uint16_t, 2>>> absentData;
+    std::vector<std::vector<std::array<uint16_t, 2>>> absentLocos;
+    bool traceValid = RailcomDecoderNative::readTrace(file, captures, expectations, dataExpectations, absentData, absentLocos);
+    std::fclose(file);
+    if (!traceValid)
+    {
+        std::printf("Invalid trace after capture %zu\n", captures.size());
+        return 1;
+    }
+
+    // zero like the memory of the firmware before it is read from flash
+    static FeedbackDecoder::ModulConfig modulConfig{};
+    modulConfig.networkId = 0x9201;
+    modulConfig.sendChannel2Data = 1;
+    std::array<int, 8> trackPin{PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7};
+    uint8_t statusLed{0};
+    static FeedbackDecoder::PowerInfoConfig powerInfoConfig{};
+    static RailcomDecoderNative decoder(modulConfig, powerInfoConfig, trackPin, statusLed, printNative, verbose);
+    // offset and threshold of every port are taken from its first capture
+    for (uint8_t port = 0; port < trackPin.size(); port++)
+    {
+        RailcomDecoderNative::Capture *first{captures.empty() ? nullptr : &captures[0]};
+        for (auto &capture : captures)
+        {
+            if ((capture.port <= port) && (port < (capture.port + capture.portsPerCapture)))
+            {
+                first = &capture;
+                break;
+            }
+        }
+        if (nullptr != first)
+        {
+            decoder.configTrack(port, first->voltageOffset, first->trackSetVoltage);
+        }
+    }
+    decoder.begin();
+    decoder.configVoting(static_cast<uint8_t>(threshold));
+
+    // capture of first report of every expectation and addresses reported on a port without expectation
+    std::vector<std::vector<size_t>> firstReport;
+    for (auto &captureExpectations : expectations)
+    {
+        firstReport.emplace_back(captureExpectations.size(), captures.size());
+    }
+    std::vector<std::array<uint16_t, 2>> unexpectedLocos;
+
+    size_t framingErrors{0};
+    size_t channel1Bytes{0};
+    size_t channel2Bytes{0};
+    size_t earlyReleases{0};
+    size_t expectationsFailed{0};
+    size_t numberOfExpectations{0};
+    size_t numberOfDatagrams{0};
+    double durationINns{0.0};
+    double channel2DurationINns{0.0};
+    size_t legacyCaptures{0};
+    size_t legacyMismatches{0};
+    double packedDurationINns{0.0};
+    double legacyDurationINns{0.0};
+
+    std::printf("capture port type  ch1 ch2 err half       ns locos\n");
+    for (size_t i = 0; i < captures.size(); i++)
+    {
+        RailcomDecoderNative::Capture &capture = captures[i];
+        nativeTimeINms += dccPacketIntervalINms;
+        RailcomDecoderNative::CaptureResult result = decoder.replay(capture);
+        double captureDurationINns = decoder.benchmark(capture, repetitions);
+        size_t captureDatagrams{0};
+        channel2DurationINns += decoder.benchmarkChannel2(capture, repetitions, captureDatagrams);
+        numberOfDatagrams += captureDatagrams;
+        RailcomDecoderNative::LegacyComparison comparison;
+        if (decoder.compareLegacy(capture, repetitions, comparison))
+        {
+            numberOfExpectations++;
+            legacyCaptures++;
+            legacyMismatches += comparison.mismatches;
+            packedDurationINns += comparison.packedINns;
+            legacyDurationINns += comparison.legacyINns;
+        }
+        channel1Bytes += result.channel1Bytes;
+        channel2Bytes += result.channel2Bytes;
+        framingErrors += result.framingErrors;
+        earlyReleases += result.earlyRelease ? 1 : 0;
+        durationINns += captureDurationINns;
+
+        std::printf("%7zu %4u %c%-4u %3zu %3zu %3zu %4c %8.1f", i, capture.port, capture.addressType, capture.address,
+                    result.channel1Bytes, result.channel2Bytes, result.framingErrors, result.earlyRelease ? 'x' : ' ', captureDurationINns);
+        if (!result.captured)
+        {
+            expectationsFailed++;
+            std::printf(" FAIL(port was not captured)");
+        }
+        for (uint8_t port = capture.port; port < (capture.port + capture.portsPerCapture); port++)
+        {
+            decoder.printBlock(stdout, port);
+        }
+        for (size_t j = 0; j < expectations.size(); j++)
+        {
+            for (size_t k = 0; k < expectations[j].size(); k++)
+            {
+                auto &expectation = expectations[j][k];
+                if ((captures.size() == firstReport[j][k]) && decoder.isLocoInBlock(expectation[2], expectation[0], expectation[1]))
+                {
+                    firstReport[j][k] = i;
+                }
+            }
+        }
+        for (uint8_t port = capture.port; port < (capture.port + capture.portsPerCapture); port++)
+        {
+            for (uint16_t address : decoder.getLocosInBlock(port))
+            {
+                bool expected{false};
+                for (auto &captureExpectations : expectations)
+                {
+                    for (auto &expectation : captureExpectations)
+                    {
+                        expected |= (address == expectation[0]) && (port == expectation[2]);
+                    }
+                }
+                bool listed{false};
+                for (auto &loco : unexpectedLocos)
+                {
+                    listed |= (address == loco[0]) && (port == loco[1]);
+                }
+                if (!expected && !listed)
+                {
+                    unexpectedLocos.push_back({address, port});
+                }
+            }
+        }
+        for (auto &expectation : expectations[i])
+        {
+            numberOfExpectations++;
+            if (!decoder.isLocoInBlock(expectation[2], expectation[0], expectation[1]))
+            {
+                expectationsFailed++;
+                std::printf(" FAIL(expected %u/0x%X on %u)", expectation[0], expectation[1], expectation[2]);
+            }
+        }
+        for (auto &expectation : dataExpectations[i])
+        {
+            numberOfExpectations++;
+            bool found{false};
+            for (auto &data : decoder.getAccessoryData())
+            {
+                found |= (data == expectation);
+            }
+            if (!found)
+            {
+                expectationsFailed++;
+                std::printf(" FAIL(expected data 0x%X %u 0x%X on %u)", expectation[1], expectation[2], expectation[3], expectation[0]);
+            }
+        }
+        for (auto &expectation : absentData[i])
+        {
+            numberOfExpectations++;
+            for (auto &data : decoder.getAccessoryData())
+            {
+                if ((data[0] == expectation[0]) && (data[1] == expectation[1]))
+                {
+                    expectationsFailed++;
+                    std::printf(" FAIL(unexpected data 0x%X %u 0x%X on %u)", data[1], data[2], data[3], data[0]);
+                    break;
+                }
+            }
+        }
+        for (auto &expectation : absentLocos[i])
+        {
+            numberOfExpectations++;
+            for (uint16_t address : decoder.getLocosInBlock(static_cast<uint8_t>(expectation[1])))
+            {
+                if (address == expectation[0])
+                {
+                    expectationsFailed++;
+                    std::printf(" FAIL(unexpected %u on %u)", expectation[0], expectation[1]);
+                }
+            }
+        }
+        if (0 != comparison.mismatches)
+        {
+            expectationsFailed++;
+            std::printf(" FAIL(%zu differences to legacy bit stream)", comparison.mismatches);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("captures: %zu, channel 1 bytes: %zu, channel 2 bytes: %zu, framing errors: %zu, can messages: %zu\n",
+                captures.size(), channel1Bytes, channel2Bytes, framingErrors, decoder.getNumberOfCanMessages());
+    std::printf("adc released after channel 1: %zu of %zu captures\n", earlyReleases, captures.size());
+    if (!captures.empty())
+    {
+        std::printf("average analysis time: %.1f ns per cutout\n", durationINns / captures.size());
+    }
+    if (0 != numberOfDatagrams)
+    {
+        std::printf("channel 2 datagrams: %zu, parsing time: %.1f ns per datagram\n", numberOfDatagrams, channel2DurationINns / numberOfDatagrams);
+    }
+    if (0 != legacyCaptures)
+    {
+        std::printf("legacy bit stream: %zu captures, %zu differences, packed %.1f ns, bool %.1f ns per cutout\n", legacyCaptures, legacyMismatches,
+                    packedDurationINns / legacyCaptures, legacyDurationINns / legacyCaptures);
+    }
+    std::printf("channel 1 threshold: %u\n", threshold);
+    for (size_t j = 0; j < expectations.size(); j++)
+    {
+        for (size_t k = 0; k < expectations[j].size(); k++)
+        {
+            auto &expectation = expectations[j][k];
+            if (captures.size() != firstReport[j][k])
+            {
+                std::printf("first report of %u/0x%X on %u: capture %zu\n", expectation[0], expectation[1], expectation[2], firstReport[j][k]);
+            }
+        }
+    }
+    for (uint8_t port = 0; port < 8; port++)
+    {
+        decoder.printStatistics(stdout, port);
+    }
+    for (auto &loco : unexpectedLocos)
+    {
+        std::printf("unexpected address %u on %u\n", loco[0], loco[1]);
+    }
+    std::printf("expectations: %zu of %zu passed\n", numberOfExpectations - expectationsFailed, numberOfExpectations);
+    return ((0 == expectationsFailed) && unexpectedLocos.empty()) ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+# Railcom codec header is copied into every project of the repository, all copies have to be byte identical.
+# Runs as pre script of every PlatformIO environment of this project or standalone: python scripts/check_codec_copies.py
+import os
+import sys
+
+CODEC_COPIES = [
+    "ZCanFeedbackBiDiSTM32FreeRtos/include/FeedbackDecoder/Railcom/Codec.h",
+    "ZCanFeedbackBiDiSTM32Arduino/include/FeedbackDecoder/Railcom/Codec.h",
+    "ZCanFeedbackBiDiSTM32Cube/Inc/RailcomCodec.h",
+    "ZCanFeedbackBiDiEsp32/include/RailcomCodec.h",
+]
+
+
+def find_differing_copies(repository_dir):
+    with open(os.path.join(repository_dir, CODEC_COPIES[0]), "rb") as file:
+        reference = file.read()
+    differing = []
+    for copy in CODEC_COPIES[1:]:
+        path = os.path.join(repository_dir, copy)
+        if not os.path.isfile(path):
+            differing.append(copy + " (missing)")
+            continue
+        with open(path, "rb") as file:
+            if file.read() != reference:
+                differing.append(copy)
+    return differing
+
+
+def check(repository_dir):
+    differing = find_differing_copies(repository_dir)
+    for copy in differing:
+        print("Railcom codec differs from %s: %s" % (CODEC_COPIES[0], copy))
+    return 0 if not differing else 1
+
+
+if __name__ == "__main__":
+    sys.exit(check(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))))
+else:
+    Import("env")  # noqa: F821, defined by PlatformIO
+    if 0 != check(os.path.dirname(env.subst("$PROJECT_DIR"))):  # noqa: F821
+        env.Exit(1)  # noqa: F821
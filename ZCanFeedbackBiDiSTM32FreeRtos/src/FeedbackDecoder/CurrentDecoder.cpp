@@ -16,10 +16,10 @@
 
 #include "FeedbackDecoder/CurrentDecoder.h"
 
-CurrentDecoder::CurrentDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+CurrentDecoder::CurrentDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                                int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...),
                                bool debug, bool zcanDebug, bool currentDebug)
-    : FeedbackDecoder(modulConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug),
+    : FeedbackDecoder(modulConfig, powerInfoConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug),
       m_currentDebug(currentDebug)
 {
 }
@@ -66,8 +66,10 @@ void CurrentDecoder::cyclicPortCheck()
     if (m_measurementCurrentSenseTriggered && !m_measurementCurrentSenseRunning && !m_measurementCurrentSenseProcessed)
     {
         uint16_t m_currentSenseSum{0};
+        uint32_t idleSum{0};
         for (uint16_t &measurement : m_adcDmaBufferCurrentSense)
         {
+            idleSum += measurement;
             if (measurement > m_trackData[m_detectionPort].voltageOffset)
             {
                 m_currentSenseSum += (measurement - m_trackData[m_detectionPort].voltageOffset);
@@ -78,8 +80,12 @@ void CurrentDecoder::cyclicPortCheck()
             }
         }
         m_currentSenseSum /= m_adcDmaBufferCurrentSense.size();
-        bool state = m_currentSenseSum > m_trackSetVoltage;
-        checkPortStatusChange(state);
+        if ((m_currentSenseSum <= m_trackData[m_detectionPort].freeVoltage) && !m_trackData[m_detectionPort].state)
+        {
+            // no load on empty block, so mean value is idle value
+            trackVoltageOffset(m_detectionPort, idleSum / m_adcDmaBufferCurrentSense.size());
+        }
+        checkPortCurrent(m_currentSenseSum);
         m_detectionPort++;
         if (m_trackData.size() > m_detectionPort)
         {
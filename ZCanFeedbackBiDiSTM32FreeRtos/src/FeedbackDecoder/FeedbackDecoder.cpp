@@ -39,7 +39,7 @@
 #include <algorithm>
 #include <cstring>
 
-FeedbackDecoder::FeedbackDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+FeedbackDecoder::FeedbackDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                                  int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...),
                                  bool debug, bool zcanDebug)
     : ZCanInterfaceObserver(printFunc, zcanDebug),
@@ -48,7 +48,8 @@ FeedbackDecoder::FeedbackDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(v
       m_configAnalogOffsetPin(configAnalogOffsetPin),
       m_configIdPin(configIdPin),
       m_statusLed(statusLed),
-      m_modulConfig(modulConfig)
+      m_modulConfig(modulConfig),
+      m_powerInfoConfig(powerInfoConfig)
 {
     auto sizeTrackData = m_trackData.size();
     auto sizeTrackPin = trackPin.size();
@@ -82,13 +83,25 @@ void FeedbackDecoder::begin()
             m_modulConfig.networkId = modulNidMin + std::max((uint32_t)1, timeINus);
         }
         m_modulConfig.modulAddress = 0x00;
-        // for (auto finding = m_modulConfig.trackConfig.begin(); finding != m_modulConfig.trackConfig.end(); ++finding)
-        m_modulConfig.trackConfig.trackSetCurrentINmA = 10;
-        m_modulConfig.trackConfig.trackFreeToSetTimeINms = 20;
-        m_modulConfig.trackConfig.trackSetToFreeTimeINms = 1000;
         m_modulConfig.sendChannel2Data = 0;
         m_saveDataFkt();
     }
+    if (currentTrackConfigVersion != m_modulConfig.trackConfigVersion)
+    {
+        // memory not set before, legacy layout is migrated before begin()
+        for (TrackConfig &trackConfig : m_modulConfig.trackConfig)
+        {
+            setDefaultTrackConfig(trackConfig);
+        }
+        m_modulConfig.trackConfigVersion = currentTrackConfigVersion;
+        m_saveDataFkt();
+    }
+    if (0xFFFF == m_powerInfoConfig.powerInfoDeltaINmA)
+    {
+        // memory of version without power info ends before it
+        m_powerInfoConfig.powerInfoDeltaINmA = 0;
+        m_saveDataFkt();
+    }
 
     // m_modulConfig.networkId = 0x9201;
     m_networkId = m_modulConfig.networkId;
@@ -97,16 +110,20 @@ void FeedbackDecoder::begin()
     uint32_t month = BUILDTM_MONTH;
     uint32_t year = BUILDTM_YEAR;
     m_buildDate = (year << 16) | (month << 8) | day;
-    // 3300mV per 4096 bits is 0.8mVperCount
-    // I have a 22 Ohm resistor so 0.8mV per Count * 22 * current is offset down below
-    // so I take 8*22 = 17,6 is round about 18
-    m_trackSetVoltage = 18 * m_modulConfig.trackConfig.trackSetCurrentINmA;
     ZCanInterfaceObserver::m_printFunc("SW Version: 0x%08X, build date: 0x%08X\n", m_firmwareVersion, m_buildDate);
     ZCanInterfaceObserver::m_printFunc("NetworkId %x MA %x CH2 %x\n", m_networkId, m_modulId, m_modulConfig.sendChannel2Data);
-    ZCanInterfaceObserver::m_printFunc("trackSetCurrentINmA: %d\n", m_modulConfig.trackConfig.trackSetCurrentINmA);
-    ZCanInterfaceObserver::m_printFunc("trackFreeToSetTimeINms: %d\n", m_modulConfig.trackConfig.trackFreeToSetTimeINms);
-    ZCanInterfaceObserver::m_printFunc("trackSetToFreeTimeINms: %d\n", m_modulConfig.trackConfig.trackSetToFreeTimeINms);
-    ZCanInterfaceObserver::m_printFunc("trackSetVoltage: %d\n", m_trackSetVoltage);
+    for (uint8_t port = 0; port < m_trackData.size(); ++port)
+    {
+        TrackConfig &trackConfig{m_modulConfig.trackConfig[port]};
+        updateTrackThresholds(port);
+        m_trackData[port].filteredCurrent = 0;
+        m_trackData[port].minCurrentINmA = 0xFFFF;
+        m_trackData[port].maxCurrentINmA = 0;
+        m_trackData[port].reportedCurrentINmA = 0;
+        m_trackData[port].powerInfoTimeINms = 0;
+        ZCanInterfaceObserver::m_printFunc("port %d set %dmA free %dmA filter %d freeToSet %dms setToFree %dms\n", port, trackConfig.trackSetCurrentINmA,
+                                           trackConfig.trackFreeCurrentINmA, trackConfig.trackFilterShift, trackConfig.trackFreeToSetTimeINms, trackConfig.trackSetToFreeTimeINms);
+    }
 
     m_pingJitterINms = std::max((uint32_t)0, std::min((micros() / 10), (uint32_t)100));
     m_pingIntervalINms = (9990 - m_pingJitterINms);
@@ -117,8 +134,10 @@ void FeedbackDecoder::begin()
 
     for (uint8_t port = 0; port < m_trackData.size(); ++port)
     {
+        m_trackData[port].filteredVoltageOffset = static_cast<int32_t>(m_trackData[port].voltageOffset) << m_voltageOffsetFilterShift;
         ZCanInterfaceObserver::m_printFunc("Offset from memory port %d: %d\n", port, m_trackData[port].voltageOffset);
     }
+    m_voltageOffsetSaveTimeINms = millis();
 
     // Wait random time before starting logging to Z21
     delay(millis() / 2);
@@ -169,6 +188,7 @@ void FeedbackDecoder::cyclic()
     ///////////////////////////////////////////////////////////////////////////
     cyclicPortCheck();
     checkDelayedStatusChange();
+    cyclicPowerInfo();
 }
 
 void FeedbackDecoder::cyclicPortCheck()
@@ -194,7 +214,7 @@ void FeedbackDecoder::checkDelayedStatusChange()
                 uint32_t currentTimeINms = millis();
                 if (port.state)
                 {
-                    if ((port.lastChangeTimeINms + m_modulConfig.trackConfig.trackFreeToSetTimeINms) < currentTimeINms)
+                    if ((port.lastChangeTimeINms + m_modulConfig.trackConfig[index].trackFreeToSetTimeINms) < currentTimeINms)
                     {
                         port.changeReported = true;
                         port.reportedState = port.state;
@@ -206,7 +226,7 @@ void FeedbackDecoder::checkDelayedStatusChange()
                 }
                 else
                 {
-                    if ((port.lastChangeTimeINms + m_modulConfig.trackConfig.trackSetToFreeTimeINms) < currentTimeINms)
+                    if ((port.lastChangeTimeINms + m_modulConfig.trackConfig[index].trackSetToFreeTimeINms) < currentTimeINms)
                     {
                         port.changeReported = true;
                         port.reportedState = port.state;
@@ -245,6 +265,18 @@ void FeedbackDecoder::callbackAdcReadFinished(ADC_HandleTypeDef *hadc)
 {
 }
 
+void FeedbackDecoder::callbackAdcReadHalfFinished(ADC_HandleTypeDef *hadc)
+{
+}
+
+void FeedbackDecoder::callbackAdcWatchdog(ADC_HandleTypeDef *hadc)
+{
+}
+
+void FeedbackDecoder::callbackAdcInjectedFinished(ADC_HandleTypeDef *hadc)
+{
+}
+
 bool FeedbackDecoder::notifyBlockOccupied(uint8_t port, uint8_t type, bool occupied)
 {
     uint16_t value = occupied ? 0x1100 : 0x0100;
@@ -262,6 +294,189 @@ void FeedbackDecoder::checkPortStatusChange(bool state)
     }
 }
 
+void FeedbackDecoder::checkPortCurrent(uint16_t currentVoltage)
+{
+    TrackData &track{m_trackData[m_detectionPort]};
+    const uint16_t filterShift{m_modulConfig.trackConfig[m_detectionPort].trackFilterShift};
+    track.filteredCurrent += ((static_cast<int32_t>(currentVoltage) << m_currentFilterFractionBits) - track.filteredCurrent) / (1 << filterShift);
+    const uint32_t current{static_cast<uint32_t>(track.filteredCurrent) >> m_currentFilterFractionBits};
+    const uint16_t currentINmA{static_cast<uint16_t>(currentVoltage / m_countsPerMilliAmpere)};
+    track.minCurrentINmA = std::min(track.minCurrentINmA, currentINmA);
+    track.maxCurrentINmA = std::max(track.maxCurrentINmA, currentINmA);
+    // single measurements around one threshold do not toggle occupancy
+    checkPortStatusChange(track.state ? (current > track.freeVoltage) : (current > track.setVoltage));
+}
+
+void FeedbackDecoder::updateTrackThresholds(uint8_t port)
+{
+    TrackConfig &trackConfig{m_modulConfig.trackConfig[port]};
+    m_trackData[port].setVoltage = m_countsPerMilliAmpere * trackConfig.trackSetCurrentINmA;
+    m_trackData[port].freeVoltage = m_countsPerMilliAmpere * std::min(trackConfig.trackFreeCurrentINmA, trackConfig.trackSetCurrentINmA);
+}
+
+uint16_t FeedbackDecoder::getCurrentINmA(uint8_t port)
+{
+    int32_t filteredCurrent{m_trackData[port].filteredCurrent};
+    return (filteredCurrent > 0) ? static_cast<uint16_t>((filteredCurrent >> m_currentFilterFractionBits) / m_countsPerMilliAmpere) : 0;
+}
+
+void FeedbackDecoder::cyclicPowerInfo()
+{
+    if (0 == m_powerInfoConfig.powerInfoDeltaINmA)
+    {
+        return;
+    }
+    uint32_t currentTimeINms{millis()};
+    for (uint8_t port = 0; port < m_trackData.size(); ++port)
+    {
+        TrackData &track{m_trackData[port]};
+        uint16_t currentINmA{getCurrentINmA(port)};
+        uint16_t delta = (currentINmA > track.reportedCurrentINmA) ? (currentINmA - track.reportedCurrentINmA) : (track.reportedCurrentINmA - currentINmA);
+        // interval limits bus load of ports with noisy current
+        if ((delta >= m_powerInfoConfig.powerInfoDeltaINmA) && ((track.powerInfoTimeINms + m_powerInfoIntervalINms) < currentTimeINms))
+        {
+            track.reportedCurrentINmA = currentINmA;
+            track.powerInfoTimeINms = currentTimeINms;
+            sendModulePowerInfoEvt(port, track.reportedState ? 0x0001 : 0x0000, 0, currentINmA);
+        }
+    }
+}
+
+void FeedbackDecoder::setDefaultTrackConfig(TrackConfig &trackConfig)
+{
+    trackConfig.trackSetCurrentINmA = 10;
+    trackConfig.trackFreeCurrentINmA = 7;
+    trackConfig.trackFilterShift = 2;
+    trackConfig.trackFreeToSetTimeINms = 20;
+    trackConfig.trackSetToFreeTimeINms = 1000;
+}
+
+bool FeedbackDecoder::isLegacyModulConfig(const ModulConfig &modulConfig)
+{
+    // unset memory has no layout
+    return (currentTrackConfigVersion != modulConfig.trackConfigVersion) && (0xFFFF != modulConfig.networkId) && (0x0 != modulConfig.networkId);
+}
+
+bool FeedbackDecoder::isValidLegacyModulConfig(const LegacyModulConfig &legacyConfig)
+{
+    if ((0xFFFF == legacyConfig.networkId) || (0x0 == legacyConfig.networkId))
+    {
+        // unset config is left for default values
+        return true;
+    }
+    const LegacyTrackConfig &trackConfig{legacyConfig.trackConfig};
+    if ((0 == trackConfig.trackSetCurrentINmA) || (maxLegacyTrackSetCurrentINmA < trackConfig.trackSetCurrentINmA) ||
+        (0xFFFF == trackConfig.trackFreeToSetTimeINms) || (0xFFFF == trackConfig.trackSetToFreeTimeINms))
+    {
+        return false;
+    }
+    for (uint16_t voltageOffset : legacyConfig.voltageOffset)
+    {
+        if (maxVoltageOffset < voltageOffset)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FeedbackDecoder::migrateModulConfig(const LegacyModulConfig &legacyConfig, ModulConfig &modulConfig)
+{
+    modulConfig.networkId = legacyConfig.networkId;
+    modulConfig.modulAddress = legacyConfig.modulAddress;
+    modulConfig.sendChannel2Data = legacyConfig.sendChannel2Data;
+    if ((0xFFFF == legacyConfig.networkId) || (0x0 == legacyConfig.networkId))
+    {
+        // begin() writes default values
+        modulConfig.trackConfigVersion = 0xFFFF;
+        return;
+    }
+    for (TrackConfig &trackConfig : modulConfig.trackConfig)
+    {
+        setDefaultTrackConfig(trackConfig);
+        trackConfig.trackSetCurrentINmA = legacyConfig.trackConfig.trackSetCurrentINmA;
+        // hysteresis of default values
+        trackConfig.trackFreeCurrentINmA = static_cast<uint16_t>((7 * legacyConfig.trackConfig.trackSetCurrentINmA) / 10);
+        trackConfig.trackFreeToSetTimeINms = legacyConfig.trackConfig.trackFreeToSetTimeINms;
+        trackConfig.trackSetToFreeTimeINms = legacyConfig.trackConfig.trackSetToFreeTimeINms;
+    }
+    modulConfig.voltageOffset = legacyConfig.voltageOffset;
+    modulConfig.trackConfigVersion = currentTrackConfigVersion;
+}
+
+uint16_t *FeedbackDecoder::findTrackConfigValue(uint32_t tag, uint8_t &port)
+{
+    // tags of ports 1 up to 8
+    port = static_cast<uint8_t>((tag & 0xFF) - 1);
+    if (port >= m_modulConfig.trackConfig.size())
+    {
+        return nullptr;
+    }
+    TrackConfig &trackConfig{m_modulConfig.trackConfig[port]};
+    switch (tag & 0xFFFFFF00)
+    {
+    case 0x00401000:
+        return &trackConfig.trackSetCurrentINmA;
+    case 0x00401100:
+        return &trackConfig.trackFreeCurrentINmA;
+    case 0x00401200:
+        return &trackConfig.trackFilterShift;
+    case 0x00501000:
+        return &trackConfig.trackFreeToSetTimeINms;
+    case 0x00511000:
+        return &trackConfig.trackSetToFreeTimeINms;
+    default:
+        return nullptr;
+    }
+}
+
+uint16_t *FeedbackDecoder::findCurrentRangeValue(uint32_t tag, uint8_t &port)
+{
+    // tags of ports 1 up to 8
+    port = static_cast<uint8_t>((tag & 0xFF) - 1);
+    if (port >= m_trackData.size())
+    {
+        return nullptr;
+    }
+    switch (tag & 0xFFFFFF00)
+    {
+    case powerInfoMinTag:
+        return &m_trackData[port].minCurrentINmA;
+    case powerInfoMaxTag:
+        return &m_trackData[port].maxCurrentINmA;
+    default:
+        return nullptr;
+    }
+}
+
+void FeedbackDecoder::trackVoltageOffset(uint8_t port, uint16_t idleValue)
+{
+    TrackData &track{m_trackData[port]};
+    // values outside of half detection threshold are current of a load or a disturbance
+    int32_t deviation{static_cast<int32_t>(idleValue) - static_cast<int32_t>(track.voltageOffset)};
+    if ((deviation * 2 >= track.setVoltage) || (-deviation * 2 >= track.setVoltage))
+    {
+        return;
+    }
+    track.filteredVoltageOffset += ((static_cast<int32_t>(idleValue) << m_voltageOffsetFilterShift) - track.filteredVoltageOffset) / (1 << m_voltageOffsetFilterShift);
+    track.voltageOffset = static_cast<uint16_t>((track.filteredVoltageOffset + (1 << (m_voltageOffsetFilterShift - 1))) >> m_voltageOffsetFilterShift);
+
+    uint16_t savedOffset{m_modulConfig.voltageOffset[port]};
+    uint16_t drift = (track.voltageOffset > savedOffset) ? (track.voltageOffset - savedOffset) : (savedOffset - track.voltageOffset);
+    if ((drift > m_voltageOffsetSaveTolerance) && ((millis() - m_voltageOffsetSaveTimeINms) >= m_voltageOffsetSaveIntervalINms))
+    {
+        // save offset of all ports with one write
+        for (uint8_t i = 0; i < m_trackData.size(); i++)
+        {
+            m_modulConfig.voltageOffset[i] = m_trackData[i].voltageOffset;
+        }
+        m_voltageOffsetSaveTimeINms = millis();
+        m_saveDataFkt();
+        if (m_debug)
+            ZCanInterfaceObserver::m_printFunc("Offset drift port %d: %d -> %d\n", port, savedOffset, track.voltageOffset);
+    }
+}
+
 void FeedbackDecoder::onBlockOccupied()
 {
 }
@@ -360,6 +575,23 @@ bool FeedbackDecoder::onRequestModulInfo(uint16_t id, uint16_t type)
     return result;
 }
 
+bool FeedbackDecoder::onRequestModulPowerInfo(uint16_t id, uint8_t port)
+{
+    bool result{false};
+    if (id == m_networkId)
+    {
+        if (m_debug)
+            ZCanInterfaceObserver::m_printFunc("onRequestModulPowerInfo %x %x\n", id, port);
+        if (port < m_trackData.size())
+        {
+            uint16_t status = m_trackData[port].reportedState ? 0x0001 : 0x0000;
+            // voltage of track is not measured
+            result = sendModulePowerInfoAck(port, status, 0, getCurrentINmA(port));
+        }
+    }
+    return result;
+}
+
 bool FeedbackDecoder::onModulPowerInfoEvt(uint16_t nid, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA)
 {
     if (m_debug)
@@ -428,45 +660,28 @@ bool FeedbackDecoder::onRequestModulObjectConfig(uint16_t id, uint32_t tag)
             result = sendModuleObjectConfigAck(m_modulId, tag, value);
             break;
 
-        case 0x00401001:
-        case 0x00401002:
-        case 0x00401003:
-        case 0x00401004:
-        case 0x00401005:
-        case 0x00401006:
-        case 0x00401007:
-        case 0x00401008:
-            value = m_modulConfig.trackConfig.trackSetCurrentINmA;
-            result = sendModuleObjectConfigAck(m_modulId, tag, value);
-            break;
-
-        case 0x00501001:
-        case 0x00501002:
-        case 0x00501003:
-        case 0x00501004:
-        case 0x00501005:
-        case 0x00501006:
-        case 0x00501007:
-        case 0x00501008:
-            value = m_modulConfig.trackConfig.trackFreeToSetTimeINms;
-            result = sendModuleObjectConfigAck(m_modulId, tag, value);
-            break;
-
-        case 0x00511001:
-        case 0x00511002:
-        case 0x00511003:
-        case 0x00511004:
-        case 0x00511005:
-        case 0x00511006:
-        case 0x00511007:
-        case 0x00511008:
-            value = m_modulConfig.trackConfig.trackSetToFreeTimeINms;
-            result = sendModuleObjectConfigAck(m_modulId, tag, value);
+        case 0x00601000:
+            result = sendModuleObjectConfigAck(m_modulId, tag, m_powerInfoConfig.powerInfoDeltaINmA);
             break;
 
         default:
+        {
+            uint8_t port;
+            uint16_t *configValue{findTrackConfigValue(tag, port)};
+            uint16_t *rangeValue{findCurrentRangeValue(tag, port)};
+            if (nullptr != configValue)
+            {
+                result = sendModuleObjectConfigAck(m_modulId, tag, *configValue);
+            }
+            else if (nullptr != rangeValue)
+            {
+                // range without measurement is 0
+                bool measured{m_trackData[port].minCurrentINmA <= m_trackData[port].maxCurrentINmA};
+                result = sendModuleObjectConfigAck(m_modulId, tag, measured ? *rangeValue : 0);
+            }
             break;
         }
+        }
     }
     return result;
 }
@@ -488,40 +703,45 @@ bool FeedbackDecoder::onCmdModulObjectConfig(uint16_t id, uint32_t tag, uint16_t
             result = sendModuleObjectConfigAck(m_modulId, tag, value);
             break;
 
-        case 0x00401001:
-            m_modulConfig.trackConfig.trackSetCurrentINmA = value;
-            m_trackSetVoltage = 18 * value;
-            if (m_debug)
-            {
-                ZCanInterfaceObserver::m_printFunc("Write SetCurrent %u\n", m_modulConfig.trackConfig.trackSetCurrentINmA);
-                ZCanInterfaceObserver::m_printFunc("Write track set voltage %u\n", m_trackSetVoltage);
-            }
-            m_saveDataFkt();
-            result = sendModuleObjectConfigAck(m_modulId, tag, value);
-            break;
-
-        case 0x00501001:
-            m_modulConfig.trackConfig.trackFreeToSetTimeINms = value;
+        case 0x00601000:
+            // 0xFFFF is unset memory
+            m_powerInfoConfig.powerInfoDeltaINmA = std::min(value, static_cast<uint16_t>(0xFFFE));
             if (m_debug)
-                ZCanInterfaceObserver::m_printFunc("Write FreeToSetTime %u\n", m_modulConfig.trackConfig.trackFreeToSetTimeINms);
-            m_saveDataFkt();
-            result = sendModuleObjectConfigAck(m_modulId, tag, value);
-            break;
-
-        case 0x00511001:
-            m_modulConfig.trackConfig.trackSetToFreeTimeINms = value;
-            if (m_debug)
-                ZCanInterfaceObserver::m_printFunc("Write SetToFreeTime %u\n", m_modulConfig.trackConfig.trackSetToFreeTimeINms);
+                ZCanInterfaceObserver::m_printFunc("Write power info delta %u\n", m_powerInfoConfig.powerInfoDeltaINmA);
             m_saveDataFkt();
             result = sendModuleObjectConfigAck(m_modulId, tag, value);
             break;
 
         default:
-            // all other values are handled
-            ZCanInterfaceObserver::m_printFunc("Handle tag %x\n", tag);
-            result = true;
+        {
+            uint8_t port;
+            uint16_t *configValue{findTrackConfigValue(tag, port)};
+            if (nullptr != configValue)
+            {
+                *configValue = (0x00401200 == (tag & 0xFFFFFF00)) ? std::min(value, m_maxTrackFilterShift) : value;
+                updateTrackThresholds(port);
+                if (m_debug)
+                    ZCanInterfaceObserver::m_printFunc("Write track config %x port %u: %u\n", tag, port, *configValue);
+                m_saveDataFkt();
+                result = sendModuleObjectConfigAck(m_modulId, tag, *configValue);
+            }
+            else if (nullptr != findCurrentRangeValue(tag, port))
+            {
+                m_trackData[port].minCurrentINmA = 0xFFFF;
+                m_trackData[port].maxCurrentINmA = 0;
+                if (m_debug)
+                    ZCanInterfaceObserver::m_printFunc("Restart current range port %u\n", port);
+                result = sendModuleObjectConfigAck(m_modulId, tag, 0);
+            }
+            else
+            {
+                // all other values are handled
+                ZCanInterfaceObserver::m_printFunc("Handle tag %x\n", tag);
+                result = true;
+            }
             break;
         }
+        }
     }
     return result;
 }
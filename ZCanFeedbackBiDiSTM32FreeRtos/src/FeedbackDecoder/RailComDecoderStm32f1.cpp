@@ -15,12 +15,17 @@
  */
 
 #include "FeedbackDecoder/RailcomDecoderStm32f1.h"
+#include "Stm32f1/tim.h"
 
-RailcomDecoderStm32f1::RailcomDecoderStm32f1(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+RailcomDecoderStm32f1::RailcomDecoderStm32f1(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                                int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...),
                                bool debug, bool zcanDebug, bool railcomDebug)
-    : RailcomDecoder(modulConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug, railcomDebug)
+    : RailcomDecoder(modulConfig, powerInfoConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug, railcomDebug)
 {
+    // cycle counter for statistics of railcom analysis
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 RailcomDecoderStm32f1::~RailcomDecoderStm32f1()
 {
@@ -34,11 +39,17 @@ void RailcomDecoderStm32f1::configAdcSingleMode()
 void RailcomDecoderStm32f1::configAdcDmaMode()
 {
     configContinuousDmaMode();
+#ifdef RAILCOM_DUAL_ADC_MODE
+    // mode is set once, switching it stops both adcs and initializes dma again, which does not fit into interrupt of dcc
+    configDualMode();
+    m_dualMode = true;
+#endif
 }
 
 uint32_t RailcomDecoderStm32f1::singleAdcRead(int channel)
 {
     setChannel(channel);
+    setExternalTrigger(ADC_SOFTWARE_START);
     // Start ADC Conversion
     HAL_ADC_Start(&hadc1);
     // Poll ADC1 Perihperal & TimeOut = 1mSec
@@ -50,6 +61,118 @@ uint32_t RailcomDecoderStm32f1::singleAdcRead(int channel)
 void RailcomDecoderStm32f1::triggerDmaRead(int channel, uint32_t *data, uint32_t length)
 {
     setChannel(channel); // 4 us
-    // start ADC conversion
+    setExternalTrigger(ADC_SOFTWARE_START);
+    // start ADC conversion, 1us per sample, 2us with adc clock of RAILCOM_DECIMATION_MODE
     HAL_ADC_Start_DMA(&hadc1, data, length); // 26 us
 }
+
+void RailcomDecoderStm32f1::triggerScanDmaRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length)
+{
+    setScanChannels(channels, numberOfChannels);
+    selectRailcomTrigger();
+    // start ADC conversion, every channel is converted in 1 us
+    HAL_ADC_Start_DMA(&hadc1, data, length);
+    startRailcomTrigger();
+}
+
+void RailcomDecoderStm32f1::triggerDualDmaRead(int channel1, int channel2, uint32_t *data, uint32_t length)
+{
+    setDualChannels(channel1, channel2);
+    selectRailcomTrigger();
+    // ADC2 is started by ADC1
+    HAL_ADCEx_MultiModeStart_DMA(&hadc1, data, length);
+    startRailcomTrigger();
+}
+
+void RailcomDecoderStm32f1::triggerDualCurrentSenseRead(int channel1, int channel2, uint32_t *data, uint32_t length)
+{
+    setDualChannels(channel1, channel2);
+    setExternalTrigger(ADC_SOFTWARE_START);
+    HAL_ADCEx_MultiModeStart_DMA(&hadc1, data, length);
+}
+
+void RailcomDecoderStm32f1::stopDmaRead()
+{
+    if (m_dualMode)
+    {
+        HAL_ADCEx_MultiModeStop_DMA(&hadc1);
+    }
+    else
+    {
+        HAL_ADC_Stop_DMA(&hadc1);
+    }
+    if (m_circularMode)
+    {
+        // railcom capture needs normal dma and no watchdog, sampling time is set again with channels of capture
+        disableAnalogWatchdog();
+        setDmaMode(DMA_NORMAL);
+        m_circularMode = false;
+    }
+}
+
+void RailcomDecoderStm32f1::triggerCircularScanRead(const int *channels, size_t numberOfChannels, uint32_t *data, uint32_t length, bool transferInterrupts)
+{
+    // 6us per conversion with both adc clocks, so that samples of a port are spread over several dcc bits
+    setScanChannelsSamplingTime(channels, numberOfChannels, m_currentSenseSamplingTime);
+    setExternalTrigger(ADC_SOFTWARE_START);
+    setDmaMode(DMA_CIRCULAR);
+    m_circularMode = true;
+    HAL_ADC_Start_DMA(&hadc1, data, length);
+    if (!transferInterrupts)
+    {
+        // buffer is overwritten endlessly, cpu only reacts on watchdog
+        disableDmaTransferInterrupts();
+    }
+}
+
+void RailcomDecoderStm32f1::armWatchdog(uint16_t lowThreshold, uint16_t highThreshold)
+{
+    enableAnalogWatchdog(lowThreshold, highThreshold);
+}
+
+void RailcomDecoderStm32f1::disarmWatchdog()
+{
+    disableAnalogWatchdog();
+}
+
+void RailcomDecoderStm32f1::triggerInjectedRead(const int *channels, size_t numberOfChannels, uint16_t periodINus)
+{
+    // ADC2 is not used by regular conversions, so injected conversions do not delay samples of railcom
+    configInjectedChannels(channels, numberOfChannels, m_currentSenseSamplingTime);
+    startInjectedConversion();
+    startInjectedTrigger(periodINus);
+}
+
+void RailcomDecoderStm32f1::setInjectedChannels(const int *channels)
+{
+    ::setInjectedChannels(channels);
+}
+
+uint16_t RailcomDecoderStm32f1::readInjectedValue(uint8_t rank)
+{
+    return getInjectedValue(rank);
+}
+
+uint32_t RailcomDecoderStm32f1::readCycleCounter()
+{
+    return DWT->CYCCNT;
+}
+
+void RailcomDecoderStm32f1::selectRailcomTrigger()
+{
+#ifdef RAILCOM_TIMER_TRIGGER
+    // compare value of previous capture would start sampling between start of dma and armAdcTrigger
+    holdAdcTrigger();
+    setExternalTrigger(ADC_EXTERNALTRIGCONV_T1_CC3);
+#else
+    setExternalTrigger(ADC_SOFTWARE_START);
+#endif
+}
+
+void RailcomDecoderStm32f1::startRailcomTrigger()
+{
+#ifdef RAILCOM_TIMER_TRIGGER
+    // if delay is already over, capture is started at once like without timer
+    armAdcTrigger(m_railcomTriggerDelayINus);
+#endif
+}
@@ -15,13 +15,23 @@
  */
 
 #include "FeedbackDecoder/RailcomDecoder.h"
+#include <algorithm>
 
-RailcomDecoder::RailcomDecoder(ModulConfig &modulConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
+RailcomDecoder::RailcomDecoder(ModulConfig &modulConfig, PowerInfoConfig &powerInfoConfig, bool (*saveDataFkt)(void), std::array<int, 8> &trackPin,
                                int configAnalogOffsetPin, int configIdPin, uint8_t &statusLed, void (*printFunc)(const char *, ...),
                                bool debug, bool zcanDebug, bool railcomDebug)
-    : FeedbackDecoder(modulConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug),
+    : FeedbackDecoder(modulConfig, powerInfoConfig, saveDataFkt, trackPin, configAnalogOffsetPin, configIdPin, statusLed, printFunc, debug, zcanDebug),
       m_railcomDebug((nullptr != m_printFunc) ? railcomDebug : 0)
 {
+#if defined(RAILCOM_DUAL_ADC_MODE)
+    configRailcomCapture(2, 1);
+#elif defined(RAILCOM_SCAN_MODE)
+    configRailcomCapture(2, 2);
+#elif defined(RAILCOM_DECIMATION_MODE)
+    configRailcomCapture(1, 2);
+#else
+    configRailcomCapture(1, 1);
+#endif
 }
 RailcomDecoder::~RailcomDecoder()
 {
@@ -78,78 +88,90 @@ void RailcomDecoder::configInputs()
         while (1)
             ;
     }
-    m_railcomSenseDataReady = xSemaphoreCreateBinary();
-    if (nullptr == m_railcomSenseDataReady)
+    for (RailcomCapture &capture : m_railcomCaptures)
     {
-        Serial.println(F("Semaphore m_railcomSenseDataReady failed"));
-        while (1)
-            ;
+        capture.state = CaptureState::eFree;
     }
     m_railcomDetectionPort = 0;
     m_railcomDetectionMeasurement = 0;
     configAdcDmaMode();
+#ifdef OCCUPANCY_INJECTED_MODE
+    std::array<int, 8> channels;
+    for (uint8_t port = 0; port < m_trackData.size(); port++)
+    {
+        channels[port] = m_trackData[port].pin;
+    }
+    triggerInjectedRead(channels.begin(), m_trackData.size(), m_injectedTriggerPeriodINus);
+#endif
 }
 
 void RailcomDecoder::cyclicPortCheck()
 {
+#if defined(OCCUPANCY_WATCHDOG_MODE)
+    cyclicWatchdogCheck();
+#elif defined(OCCUPANCY_SCAN_MODE) || defined(OCCUPANCY_INJECTED_MODE)
     if (pdTRUE == xSemaphoreTake(m_currentSenseDataReady, 0))
     {
-        uint32_t m_currentSenseSum{0};
-        for (uint16_t &measurement : m_adcDmaBufferCurrentSense)
+        // means of last pass of scan
+        for (m_detectionPort = 0; m_detectionPort < m_trackData.size(); m_detectionPort++)
         {
-            if (measurement > m_trackData[m_detectionPort].voltageOffset)
-            {
-                m_currentSenseSum += (measurement - m_trackData[m_detectionPort].voltageOffset);
-            }
-            else
-            {
-                m_currentSenseSum += (m_trackData[m_detectionPort].voltageOffset - measurement);
-            }
+            checkCurrentSense(m_currentSense[m_detectionPort].deviation, m_currentSense[m_detectionPort].idleValue);
         }
-        m_currentSenseSum /= m_adcDmaBufferCurrentSense.size();
-        bool state = m_currentSenseSum > m_trackSetVoltage;
-        checkPortStatusChange(state);
+        m_detectionPort = 0;
+    }
+#else
+    if (pdTRUE == xSemaphoreTake(m_currentSenseDataReady, 0))
+    {
+#ifdef RAILCOM_DUAL_ADC_MODE
+        // adc2 sampled next port at the same time, samples of both ports are interleaved
+        evaluateCurrentSense(0, 2);
         m_detectionPort++;
-        if (m_trackData.size() > m_detectionPort)
-        {
-            triggerDmaRead(m_trackData[m_detectionPort].pin, (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size());
-        }
-        else
+        evaluateCurrentSense(1, 2);
+#else
+        evaluateCurrentSense(0, 1);
+#endif
+        m_detectionPort++;
+        if (m_trackData.size() <= m_detectionPort)
         {
             // no more measurements
             m_currentSenseRunning = false;
         }
     }
+#endif
     ///////////////////////////////////////////////////////////////////////////
     // process Railcom data from ADC
-    if (pdTRUE == xSemaphoreTake(m_railcomSenseDataReady, 0))
-    {
-        // std::array<uint16_t, 512> dmaBuffer;
-        //  copy DMA buffer to make sure that data is not overwritten in case that we take to long to analyze
-        // dmaBuffer = m_adcDmaBuffer;
-        analyzeRailcomData((uint16_t *)m_adcDmaBufferRailcom.begin(), 400, m_trackData[m_railcomDetectionPort].voltageOffset, m_trackSetVoltage);
-        m_addrReceived = AddressType::eNone;
-        // prepare already next measurement
-        m_railcomDetectionMeasurement++;
-        if (m_maxNumberOfConsecutiveMeasurements <= m_railcomDetectionMeasurement)
-        {
-            m_railcomDetectionMeasurement = 0;
-            if (m_trackData.size() <= (m_railcomDetectionPort + 1))
-            {
-                m_railcomDetectionPort = 0;
-            }
-            else
+    // channel 1 is analyzed after first half of DMA transfer, adc may already capture next cutout into other buffer
+    RailcomCapture &capture{m_railcomCaptures[m_railcomAnalysisIndex]};
+    if (capture.channel1Analyzed && !capture.channel1Evaluated)
+    {
+        // dcc.process() decoded the packet since channel 1 was analyzed, so its address type is final
+        evaluateRailcomCaptureChannel1(capture);
+    }
+    if (!capture.channel1Analyzed && ((CaptureState::eChannel1Ready == capture.state) || (CaptureState::eComplete == capture.state)))
+    {
+        analyzeRailcomCaptureChannel1(capture);
+    }
+    if (capture.channel1Evaluated && (CaptureState::eComplete == capture.state))
+    {
+        // address of dcc packet is available after decoding of packet
+        m_lastRailcomAddress = capture.lastRailcomAddress;
+        m_addrReceived = capture.addrReceived;
+        const size_t length{capture.length / m_railcomPortsPerCapture};
+        if (capture.channel2Data)
+        {
+            for (uint8_t capturePort = 0; (capturePort < m_railcomPortsPerCapture) && ((capture.port + capturePort) < m_trackData.size()); capturePort++)
             {
-                m_railcomDetectionPort++;
+                RailcomChannelData channel2;
+                selectRailcomCapturePort(capture.samples.data(), capture.port, capturePort);
+                const uint32_t startCycles{readCycleCounter()};
+                analyzeRailcomChannel2(channel2, length / 2, length, m_trackData[m_railcomAnalyzedPort].voltageOffset, m_trackData[m_railcomAnalyzedPort].setVoltage);
+                countRailcomAnalysis(m_railcomAnalyzedPort, channel2, readCycleCounter() - startCycles);
             }
         }
-
-        //  trigger measurement of current sense
-        m_detectionPort = 0;
-        m_currentSenseRunning = true;
-        m_railcomSenseRunning = false;
-        triggerDmaRead(m_trackData[m_detectionPort].pin, (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size()); // 26 us
+        finishRailcomMeasurement(capture);
     }
+    triggerCurrentSense();
+    cyclicTelemetryCheck();
 
     // check for address data which was not renewed
     for (auto &data : m_railcomData[m_cyclicRailcomCheckPort].railcomAddr)
@@ -163,6 +185,7 @@ void RailcomDecoder::cyclicPortCheck()
                 {
                     m_printFunc("L leftTime:0x%X %u\n", data.address, m_cyclicRailcomCheckPort);
                 }
+                removeFromLocoPortIndex(data.address, m_cyclicRailcomCheckPort);
                 data.address = 0;
                 data.direction = 0;
                 data.lastChangeTimeINms = millis();
@@ -179,6 +202,321 @@ void RailcomDecoder::cyclicPortCheck()
     }
 }
 
+void RailcomDecoder::analyzeRailcomCaptureChannel1(RailcomCapture &capture)
+{
+    const size_t halfLength{m_railcomCaptureLength / 2 / m_railcomPortsPerCapture};
+    capture.channel2Data = false;
+    for (uint8_t capturePort = 0; (capturePort < m_railcomPortsPerCapture) && ((capture.port + capturePort) < m_trackData.size()); capturePort++)
+    {
+        RailcomChannelData channel1;
+        selectRailcomCapturePort(capture.samples.data(), capture.port, capturePort);
+        const uint32_t startCycles{readCycleCounter()};
+        analyzeRailcomChannel1(channel1, halfLength, m_trackData[m_railcomAnalyzedPort].voltageOffset, m_trackData[m_railcomAnalyzedPort].setVoltage,
+                               capture.channel1[capturePort]);
+        m_railcomStatistics[m_railcomAnalyzedPort].cutouts++;
+        m_railcomStatistics[m_railcomAnalyzedPort].lastAnalysisCycles = 0;
+        countRailcomAnalysis(m_railcomAnalyzedPort, channel1, readCycleCounter() - startCycles);
+        trackRailcomIdleValue(m_railcomTiming.startChannel1, halfLength);
+        capture.channel2Data |= hasChannel2Data(halfLength);
+    }
+    capture.channel1Analyzed = true;
+    if (!capture.channel2Data)
+    {
+        // no start bit of channel 2, so release adc for next capture and current sense measurement
+        releaseRailcomCapture(capture);
+    }
+    // half transfer is often done before the packet is decoded, an srq must not be voted as loco address
+    if (AddressType::eNone != capture.addrReceived)
+    {
+        evaluateRailcomCaptureChannel1(capture);
+    }
+}
+
+void RailcomDecoder::evaluateRailcomCaptureChannel1(RailcomCapture &capture)
+{
+    m_lastRailcomAddress = capture.lastRailcomAddress;
+    m_addrReceived = capture.addrReceived;
+    for (uint8_t capturePort = 0; (capturePort < m_railcomPortsPerCapture) && ((capture.port + capturePort) < m_trackData.size()); capturePort++)
+    {
+        selectRailcomCapturePort(capture.samples.data(), capture.port, capturePort);
+        evaluateRailcomChannel1(capture.channel1[capturePort]);
+    }
+    capture.channel1Evaluated = true;
+}
+
+void RailcomDecoder::releaseRailcomCapture(RailcomCapture &capture)
+{
+    noInterrupts();
+    if (CaptureState::eChannel1Ready == capture.state)
+    {
+        // dma of this capture is still running
+        stopDmaRead();
+        m_railcomSenseRunning = false;
+        m_railcomCaptureIndex = (m_railcomCaptureIndex + 1) % m_railcomCaptures.size();
+        capture.length = m_railcomCaptureLength / 2;
+        capture.state = CaptureState::eComplete;
+    }
+    interrupts();
+}
+
+void RailcomDecoder::finishRailcomMeasurement(RailcomCapture &capture)
+{
+#ifdef RAILCOM_TRACE
+    if (1 < m_railcomPortsPerCapture)
+    {
+        m_printFunc("S %u %u\n", m_railcomPortsPerCapture, m_railcomSamplePeriodINus);
+    }
+    m_printFunc("T %u %u %u %c %u %u", capture.port, m_trackData[capture.port].voltageOffset, m_trackData[capture.port].setVoltage,
+                (AddressType::eLoco == capture.addrReceived) ? 'L' : ((AddressType::eAcc == capture.addrReceived) ? 'A' : 'N'), capture.lastRailcomAddress, capture.length);
+    for (size_t i = 0; i < capture.length; i++)
+    {
+        m_printFunc(" %u", capture.samples[i]);
+    }
+    m_printFunc("\n");
+#endif
+    m_addrReceived = AddressType::eNone;
+    // buffer is free for next capture
+    capture.state = CaptureState::eFree;
+    m_railcomAnalysisIndex = (m_railcomAnalysisIndex + 1) % m_railcomCaptures.size();
+
+    // measure current sense of all ports, a measurement which is already in progress is continued
+    if (!m_currentSenseRunning)
+    {
+        m_detectionPort = 0;
+        m_currentSenseRunning = true;
+    }
+}
+
+void RailcomDecoder::prepareNextRailcomCapture()
+{
+    m_railcomDetectionMeasurement++;
+    if (m_maxNumberOfConsecutiveMeasurements <= m_railcomDetectionMeasurement)
+    {
+        m_railcomDetectionMeasurement = 0;
+        m_railcomDetectionPort = selectNextRailcomPort();
+    }
+}
+
+uint8_t RailcomDecoder::selectNextRailcomPort()
+{
+    const uint32_t currentTimeINms{millis()};
+    uint8_t nextPort{0};
+    uint16_t highestCredit{0};
+    for (uint8_t port = 0; port < m_trackData.size(); port += m_railcomPortsPerCapture)
+    {
+        // ports of one capture are weighted by the port which needs it most
+        uint8_t weight{0};
+        for (uint8_t capturePort = port; (capturePort < (port + m_railcomPortsPerCapture)) && (capturePort < m_trackData.size()); capturePort++)
+        {
+            uint8_t portWeight{getRailcomPortWeight(capturePort, currentTimeINms)};
+            weight = (portWeight > weight) ? portWeight : weight;
+        }
+        // free ports do not save credit for later
+        m_railcomPortCredit[port] = (0 != weight) ? (m_railcomPortCredit[port] + weight) : 0;
+        if (m_railcomPortCredit[port] > highestCredit)
+        {
+            highestCredit = m_railcomPortCredit[port];
+            nextPort = port;
+        }
+    }
+    if (0 == highestCredit)
+    {
+        // no port is occupied, so every port is captured one after another
+        return (m_trackData.size() <= (m_railcomDetectionPort + m_railcomPortsPerCapture)) ? 0 : (m_railcomDetectionPort + m_railcomPortsPerCapture);
+    }
+    m_railcomPortCredit[nextPort] = 0;
+    return nextPort;
+}
+
+uint8_t RailcomDecoder::getRailcomPortWeight(uint8_t port, uint32_t currentTimeINms)
+{
+    if (!m_trackData[port].state)
+    {
+        return 0;
+    }
+    if ((currentTimeINms - m_trackData[port].lastChangeTimeINms) < m_railcomRecentChangeINms)
+    {
+        return m_railcomWeightSearching;
+    }
+    // oldest refresh of all addresses of port
+    bool addressKnown{false};
+    uint32_t oldestRefreshINms{currentTimeINms};
+    for (auto &data : m_railcomData[port].railcomAddr)
+    {
+        if (0 != data.address)
+        {
+            addressKnown = true;
+            if ((currentTimeINms - data.lastChangeTimeINms) > (currentTimeINms - oldestRefreshINms))
+            {
+                oldestRefreshINms = data.lastChangeTimeINms;
+            }
+        }
+    }
+    if (!addressKnown)
+    {
+        return m_railcomWeightSearching;
+    }
+    return ((currentTimeINms - oldestRefreshINms) < m_railcomStableAddressINms) ? m_railcomWeightStable : m_railcomWeightRefresh;
+}
+
+void RailcomDecoder::triggerCurrentSense()
+{
+    // railcom capture is started in interrupt of dcc, so adc has to be checked and started at once
+    noInterrupts();
+#if defined(OCCUPANCY_WATCHDOG_MODE) || defined(OCCUPANCY_SCAN_MODE)
+    // scan of all ports runs until it is stopped by next railcom capture
+    if (!m_currentSenseDmaRunning && !m_railcomSenseRunning)
+    {
+        std::array<int, 8> channels;
+        for (uint8_t port = 0; port < m_trackData.size(); port++)
+        {
+            channels[port] = m_trackData[port].pin;
+        }
+        m_currentSenseDmaRunning = true;
+#ifdef OCCUPANCY_SCAN_MODE
+        // sums of interrupted pass are discarded
+        for (CurrentSense &currentSense : m_currentSense)
+        {
+            currentSense.deviationSum = 0;
+            currentSense.sampleSum = 0;
+        }
+        triggerCircularScanRead(channels.begin(), m_trackData.size(), (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size(), true);
+#else
+        triggerCircularScanRead(channels.begin(), m_trackData.size(), (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size(), false);
+        if (m_watchdogArmed)
+        {
+            uint16_t lowThreshold;
+            uint16_t highThreshold;
+            getWatchdogWindow(lowThreshold, highThreshold);
+            armWatchdog(lowThreshold, highThreshold);
+        }
+#endif
+    }
+#elif !defined(OCCUPANCY_INJECTED_MODE)
+    // injected group of OCCUPANCY_INJECTED_MODE does not need regular conversions
+    if (m_currentSenseRunning && !m_currentSenseDmaRunning && !m_railcomSenseRunning)
+    {
+        m_currentSenseDmaRunning = true;
+#ifdef RAILCOM_DUAL_ADC_MODE
+        // adc stays in dual mode, so that the railcom capture in interrupt of dcc does not switch it
+        triggerDualCurrentSenseRead(m_trackData[m_detectionPort].pin, m_trackData[m_detectionPort + 1].pin,
+                                    (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size() / 2);
+#else
+        triggerDmaRead(m_trackData[m_detectionPort].pin, (uint32_t *)m_adcDmaBufferCurrentSense.begin(), m_adcDmaBufferCurrentSense.size()); // 26 us
+#endif
+    }
+#endif
+    interrupts();
+}
+
+void RailcomDecoder::evaluateCurrentSense(size_t firstSample, size_t step)
+{
+    const uint16_t voltageOffset{m_trackData[m_detectionPort].voltageOffset};
+    uint32_t currentSenseSum{0};
+    uint32_t idleSum{0};
+    uint32_t numberOfSamples{0};
+    for (size_t i = firstSample; i < m_adcDmaBufferCurrentSense.size(); i += step)
+    {
+        uint16_t measurement{m_adcDmaBufferCurrentSense[i]};
+        idleSum += measurement;
+        if (measurement > voltageOffset)
+        {
+            currentSenseSum += (measurement - voltageOffset);
+        }
+        else
+        {
+            currentSenseSum += (voltageOffset - measurement);
+        }
+        numberOfSamples++;
+    }
+    checkCurrentSense(currentSenseSum / numberOfSamples, idleSum / numberOfSamples);
+}
+
+void RailcomDecoder::checkCurrentSense(uint16_t deviation, uint16_t idleValue)
+{
+    if ((deviation <= m_trackData[m_detectionPort].freeVoltage) && !m_trackData[m_detectionPort].state)
+    {
+        // no load on empty block, so mean value is idle value
+        trackVoltageOffset(m_detectionPort, idleValue);
+    }
+    checkPortCurrent(deviation);
+}
+
+void RailcomDecoder::accumulateCurrentSense(size_t startIndex, size_t endIndex)
+{
+    for (size_t i = startIndex; i < endIndex; i += m_trackData.size())
+    {
+        for (uint8_t port = 0; port < m_trackData.size(); port++)
+        {
+            addCurrentSenseSample(port, m_adcDmaBufferCurrentSense[i + port]);
+        }
+    }
+}
+
+void RailcomDecoder::addCurrentSenseSample(uint8_t port, uint16_t measurement)
+{
+    const uint16_t voltageOffset{m_trackData[port].voltageOffset};
+    m_currentSense[port].deviationSum += (measurement > voltageOffset) ? (measurement - voltageOffset) : (voltageOffset - measurement);
+    m_currentSense[port].sampleSum += measurement;
+}
+
+void RailcomDecoder::publishCurrentSense(uint32_t numberOfSamples)
+{
+    for (CurrentSense &currentSense : m_currentSense)
+    {
+        currentSense.deviation = currentSense.deviationSum / numberOfSamples;
+        currentSense.idleValue = currentSense.sampleSum / numberOfSamples;
+        currentSense.deviationSum = 0;
+        currentSense.sampleSum = 0;
+    }
+}
+
+void RailcomDecoder::cyclicWatchdogCheck()
+{
+    const uint32_t currentTimeINms{millis()};
+    if ((m_watchdogTriggered || !m_watchdogArmed) && ((currentTimeINms - m_watchdogEvaluationTimeINms) >= m_watchdogEvaluationIntervalINms))
+    {
+        m_watchdogEvaluationTimeINms = currentTimeINms;
+        m_watchdogTriggered = false;
+        // samples of ports are interleaved in scan
+        bool occupied{false};
+        for (m_detectionPort = 0; m_detectionPort < m_trackData.size(); m_detectionPort++)
+        {
+            evaluateCurrentSense(m_detectionPort, m_trackData.size());
+            occupied |= m_trackData[m_detectionPort].state;
+        }
+        m_detectionPort = 0;
+        if (!occupied)
+        {
+            // scan is armed at its next start if it is stopped by a railcom capture
+            noInterrupts();
+            m_watchdogArmed = true;
+            if (m_currentSenseDmaRunning)
+            {
+                uint16_t lowThreshold;
+                uint16_t highThreshold;
+                getWatchdogWindow(lowThreshold, highThreshold);
+                armWatchdog(lowThreshold, highThreshold);
+            }
+            interrupts();
+        }
+    }
+}
+
+void RailcomDecoder::getWatchdogWindow(uint16_t &lowThreshold, uint16_t &highThreshold)
+{
+    // window is intersection of set windows of all ports, if it is empty ports are evaluated every interval
+    int32_t low{0};
+    int32_t high{0xFFF};
+    for (TrackData &track : m_trackData)
+    {
+        low = std::max(low, static_cast<int32_t>(track.voltageOffset) - static_cast<int32_t>(track.setVoltage));
+        high = std::min(high, static_cast<int32_t>(track.voltageOffset) + static_cast<int32_t>(track.setVoltage));
+    }
+    lowThreshold = static_cast<uint16_t>(low);
+    highThreshold = static_cast<uint16_t>(std::max(high, 0));
+}
+
 void RailcomDecoder::onBlockOccupied()
 {
     notifyLocoInBlock(m_detectionPort, m_railcomData[m_detectionPort].railcomAddr);
@@ -194,6 +532,7 @@ void RailcomDecoder::onBlockEmpty(size_t blockNum)
     //     }
     // }
     RailcomData &block{m_railcomData[blockNum]};
+    block.collisionHits = 0;
     for (RailcomAddr &railcomAddr : block.railcomAddr)
     {
         if (0 != railcomAddr.address)
@@ -202,56 +541,188 @@ void RailcomDecoder::onBlockEmpty(size_t blockNum)
             {
                 ZCanInterfaceObserver::m_printFunc("L leftBlock:0x%X %u\n", railcomAddr.address, blockNum);
             }
+            removeFromLocoPortIndex(railcomAddr.address, blockNum);
         }
         railcomAddr.address = 0;
         railcomAddr.direction = 0;
         railcomAddr.lastChangeTimeINms = millis();
         railcomAddr.changeReported = false;
     }
-    m_railcomData[blockNum].channel1Data[0].id = 0;
-    m_railcomData[blockNum].channel1Data[1].id = 0;
-    m_railcomData[blockNum].channel1Data[0].data[0] = 0;
-    m_railcomData[blockNum].channel1Data[1].data[0] = 0;
+    for (Channel1Votes &votes : m_railcomData[blockNum].channel1Votes)
+    {
+        votes.fill(Channel1Candidate());
+    }
     notifyLocoInBlock(blockNum, m_railcomData[blockNum].railcomAddr);
 }
 
 void RailcomDecoder::callbackDccReceived()
 {
-    if (!m_currentSenseRunning && !m_railcomSenseRunning)
+    RailcomCapture &capture{m_railcomCaptures[m_railcomCaptureIndex]};
+    // buffer of previous capture may still be analyzed, then this cutout is skipped
+    if (!m_railcomSenseRunning && (CaptureState::eFree == capture.state))
     {
+        if (m_currentSenseDmaRunning)
+        {
+            // railcom has priority, port is measured again afterwards
+            stopDmaRead();
+            m_currentSenseDmaRunning = false;
+        }
+        // loco of last packet is expected to be addressed again, e.g. by repetition of command
+        uint8_t firstPort{m_railcomDetectionPort};
+        uint8_t targetPort{m_railcomTargetPort};
+        m_railcomTargetPort = noRailcomPort;
+        m_railcomCaptureTargeted = (noRailcomPort != targetPort) && !m_railcomCaptureTargeted;
+        if (m_railcomCaptureTargeted)
+        {
+            firstPort = targetPort - (targetPort % m_railcomPortsPerCapture);
+        }
         m_railcomSenseRunning = true;
+        capture.state = CaptureState::eCapturing;
+        capture.port = firstPort;
+        capture.length = m_railcomCaptureLength;
+        capture.channel1Analyzed = false;
+        capture.channel1Evaluated = false;
+        capture.channel2Data = false;
+        capture.addrReceived = AddressType::eNone;
+        capture.lastRailcomAddress = 0;
+        m_railcomAddressIndex = m_railcomCaptureIndex;
         // after DMA was executed, configure next channel already to save time
-        triggerDmaRead(m_trackData[m_railcomDetectionPort].pin, (uint32_t *)m_adcDmaBufferRailcom.begin(), m_adcDmaBufferRailcom.size()); // 26 us
+        std::array<int, maxPortsPerCapture> channels;
+        size_t numberOfChannels{0};
+        for (; (numberOfChannels < m_railcomPortsPerCapture) && ((firstPort + numberOfChannels) < m_trackData.size()); numberOfChannels++)
+        {
+            channels[numberOfChannels] = m_trackData[firstPort + numberOfChannels].pin;
+        }
+        if ((2 == numberOfChannels) && (1 == m_railcomSamplePeriodINus))
+        {
+            // two samples per 32 bit transfer
+            triggerDualDmaRead(channels[0], channels[1], (uint32_t *)capture.samples.data(), m_railcomCaptureLength / 2);
+        }
+        else
+        {
+            triggerScanDmaRead(channels.begin(), numberOfChannels, (uint32_t *)capture.samples.data(), m_railcomCaptureLength); // 26 us
+        }
+        if (firstPort == m_railcomDetectionPort)
+        {
+            prepareNextRailcomCapture();
+        }
+    }
+    else
+    {
+        // address of this packet does not belong to any capture
+        m_railcomAddressIndex = noRailcomCapture;
     }
 }
 
 void RailcomDecoder::callbackAccAddrReceived(uint16_t addr)
 {
-    m_lastRailcomAddress = addr;
-    m_addrReceived = AddressType::eAcc;
+    // packet is decoded after its cutout was captured
+    uint8_t index{m_railcomAddressIndex};
+    if (noRailcomCapture != index)
+    {
+        m_railcomCaptures[index].lastRailcomAddress = addr;
+        m_railcomCaptures[index].addrReceived = AddressType::eAcc;
+    }
     FeedbackDecoder::callbackAccAddrReceived(addr);
 }
 
 void RailcomDecoder::callbackLocoAddrReceived(uint16_t addr)
 {
-    m_lastRailcomAddress = addr;
-    m_addrReceived = AddressType::eLoco;
+    uint8_t index{m_railcomAddressIndex};
+    if (noRailcomCapture != index)
+    {
+        m_railcomCaptures[index].lastRailcomAddress = addr;
+        m_railcomCaptures[index].addrReceived = AddressType::eLoco;
+    }
+    uint8_t port{findLocoPort(addr)};
+    if (noRailcomPort == port)
+    {
+        // loco may be one of the locos whose channel 1 collides, its answer in channel 2 confirms it
+        port = findCollisionPort();
+    }
+    if (noRailcomPort != port)
+    {
+        m_railcomTargetPort = port;
+    }
 }
 
-void RailcomDecoder::callbackAdcReadFinished(ADC_HandleTypeDef *hadc)
+void RailcomDecoder::callbackAdcReadFinished(ADC_HandleTypeDef * /*hadc*/)
 {
     BaseType_t xHigherPriorityTaskWoken{pdFALSE};
     if (m_railcomSenseRunning)
     {
-        xSemaphoreGiveFromISR(m_railcomSenseDataReady, &xHigherPriorityTaskWoken);
+        // hand buffer over to cyclicPortCheck and switch to next one
+        m_railcomCaptures[m_railcomCaptureIndex].state = CaptureState::eComplete;
+        m_railcomCaptureIndex = (m_railcomCaptureIndex + 1) % m_railcomCaptures.size();
+        m_railcomSenseRunning = false;
     }
-    else if (m_currentSenseRunning)
+    else if (m_currentSenseDmaRunning)
     {
+#ifdef OCCUPANCY_SCAN_MODE
+        // pass is complete, scan continues with first half of buffer
+        const size_t length{m_adcDmaBufferCurrentSense.size()};
+        accumulateCurrentSense(length / 2, length);
+        publishCurrentSense(length / m_trackData.size());
+#else
+        m_currentSenseDmaRunning = false;
+#endif
         xSemaphoreGiveFromISR(m_currentSenseDataReady, &xHigherPriorityTaskWoken);
     }
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
 
+void RailcomDecoder::callbackAdcReadHalfFinished(ADC_HandleTypeDef * /*hadc*/)
+{
+    if (m_railcomSenseRunning)
+    {
+        m_railcomCaptures[m_railcomCaptureIndex].state = CaptureState::eChannel1Ready;
+    }
+#ifdef OCCUPANCY_SCAN_MODE
+    else if (m_currentSenseDmaRunning)
+    {
+        // first half is summed while dma writes second half
+        accumulateCurrentSense(0, m_adcDmaBufferCurrentSense.size() / 2);
+    }
+#endif
+}
+
+void RailcomDecoder::callbackAdcInjectedFinished(ADC_HandleTypeDef * /*hadc*/)
+{
+    BaseType_t xHigherPriorityTaskWoken{pdFALSE};
+    const uint8_t firstPort = m_injectedGroup * injectedChannels;
+    for (uint8_t rank = 0; rank < injectedChannels; rank++)
+    {
+        addCurrentSenseSample(firstPort + rank, readInjectedValue(rank));
+    }
+    // next group of ports is converted by next trigger
+    m_injectedGroup = (m_injectedGroup + 1) % (m_trackData.size() / injectedChannels);
+    std::array<int, injectedChannels> channels;
+    for (uint8_t rank = 0; rank < injectedChannels; rank++)
+    {
+        channels[rank] = m_trackData[m_injectedGroup * injectedChannels + rank].pin;
+    }
+    setInjectedChannels(channels.begin());
+    if (0 == m_injectedGroup)
+    {
+        m_injectedPasses++;
+        if (m_injectedPassesPerMean <= m_injectedPasses)
+        {
+            m_injectedPasses = 0;
+            publishCurrentSense(m_injectedPassesPerMean);
+            xSemaphoreGiveFromISR(m_currentSenseDataReady, &xHigherPriorityTaskWoken);
+        }
+    }
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+void RailcomDecoder::callbackAdcWatchdog(ADC_HandleTypeDef * /*hadc*/)
+{
+    // watchdog would interrupt again with every further sample outside of window
+    disarmWatchdog();
+    m_watchdogArmed = false;
+    m_watchdogTriggered = true;
+}
+
 bool RailcomDecoder::onAccessoryData(uint16_t accessoryId, uint8_t port, uint8_t type)
 {
     bool result{false};
@@ -276,354 +747,809 @@ bool RailcomDecoder::onAccessoryData(uint16_t accessoryId, uint8_t port, uint8_t
     return result;
 }
 
-// analyze incoming bit stream for railcom data and act accordingly
-void RailcomDecoder::analyzeRailcomData(uint16_t dmaBufferIN1samplePer1us[], size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage)
+bool RailcomDecoder::onRequestModulObjectConfig(uint16_t id, uint32_t tag)
 {
-    RailcomChannelData channel1;
-    RailcomChannelData channel2;
-    m_channel1Direction = 0;
-    m_channel2Direction = 0;
-    m_dmaBufferIN1samplePer1us = dmaBufferIN1samplePer1us;
-    // get possible uart bytes of serial communication including start position in stream and polarity to check direction
-    handleBitStream(dmaBufferIN1samplePer1us, length, channel1, channel2, voltageOffset, trackSetVoltage);
-
-    // bool dataReceivedChannel1{false};
-
-    if (channel1.size >= 2)
+    const uint8_t index{static_cast<uint8_t>((tag >> 16) & 0x0F)};
+    const uint8_t port{static_cast<uint8_t>((tag & 0xFF) - 1)};
+    if ((id == m_networkId) && (railcomStatisticsTag == (tag & 0xFFF0FF00)) && (index < 8) && (port < m_railcomStatistics.size()))
     {
-        // at least 2 bytes
-        // run through analytics of every two bytes
-        size_t maxIndex{channel1.size - 1};
-        for (size_t i = 0; i < maxIndex; i++)
-        {
-
-            uint8_t highByte{channel1.bytes[i].data};
-            uint8_t lowByte{channel1.bytes[i + 1].data};
-            if ((highByte < 0x40) && (lowByte < 0x40))
-            {
-                if ((channel1.bytes[i + 1].startIndex - channel1.bytes[i].endIndex) < 6) // one byte commes direct after another
-                {
-                    // check if start index of first byte is near second byte start index
-                    uint8_t railcomValue = ((highByte & 0x03) << 6) | (lowByte & 0x3F);
-                    RailcomPacket12Bit packet({highByte, lowByte});
-                    if ((1 == packet.id) || (2 == packet.id))
-                    {
-                        uint16_t locoAddr{0};
-                        if (0x01 == packet.id)
-                        {
-                            if (m_railcomData[m_railcomDetectionPort].channel1Data[0].id != packet.id)
-                            {
-                                m_railcomData[m_railcomDetectionPort].channel1Data[0].id = 1;
-                                m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] = railcomValue;
-                            }
-                            else if (m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] != railcomValue)
-                            {
-                                m_railcomData[m_railcomDetectionPort].channel1Data[1].id = 0;
-                                m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0] = 0;
-                            }
-                        }
-                        else if (0x02 == packet.id)
-                        {
-                            if (m_railcomData[m_railcomDetectionPort].channel1Data[1].id != packet.id)
-                            {
-                                m_railcomData[m_railcomDetectionPort].channel1Data[1].id = 2;
-                                m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0] = railcomValue;
-                            }
-                            else if (m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0] != railcomValue)
-                            {
-                                m_railcomData[m_railcomDetectionPort].channel1Data[0].id = 0;
-                                m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] = 0;
-                            }
-                        }
-                        if ((1 == m_railcomData[m_railcomDetectionPort].channel1Data[0].id) && (2 == m_railcomData[m_railcomDetectionPort].channel1Data[1].id))
-                        {
-                            if (0x00 == (m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] & 0xB0))
-                            {
-                                // Base address CV1
-                                locoAddr = m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0] & 0x7F;
-                            }
-                            else if (0x60 == (m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] & 0xFF))
-                            {
-                                // Multiple Traction address CV19
-                                locoAddr = m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0] & 0x7F;
-                            }
-                            else if (0x80 == (m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] & 0xB0))
-                            {
-                                // Extended address CV17 + CV18
-                                locoAddr = ((m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0] & 0x3F) << 8) | m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0];
-                            }
-                        }
-
-                        if ((4 == channel1.bytes[i].direction) && (4 == channel1.bytes[i + 1].direction))
-                        {
-                            m_channel1Direction = 0x10;
-                        }
-                        else if ((-4 == channel1.bytes[i].direction) && (-4 == channel1.bytes[i + 1].direction))
-                        {
-                            m_channel1Direction = 0x11;
-                        }
-
-                        std::array<uint16_t, 4> data = {m_railcomData[m_railcomDetectionPort].channel1Data[0].id, m_railcomData[m_railcomDetectionPort].channel1Data[0].data[0], m_railcomData[m_railcomDetectionPort].channel1Data[1].id, m_railcomData[m_railcomDetectionPort].channel1Data[1].data[0]};
-                        handleFoundLocoAddr(locoAddr, m_channel1Direction, Channel::eChannel1, data);
-
-                        // m_printFunc("L %X %X %X %X\n", railcomId, railcomValue, m_railcomData[m_railcomDetectionPort].lastChannelId, m_railcomData[m_railcomDetectionPort].lastChannelData);
-
-                        // m_railcomData[m_railcomDetectionPort].lastChannelId = railcomId;
-                        // m_railcomData[m_railcomDetectionPort].lastChannelData = railcomValue;
-                        // dataReceivedChannel1 = true;
-                        break;
-                    }
-                }
-            }
-        }
+        if (m_railcomDebug)
+            ZCanInterfaceObserver::m_printFunc("Statistics %u of port %u\n", index, port);
+        return sendModuleObjectConfigAck(m_modulId, tag, getRailcomStatistic(port, index));
     }
-    // if (!dataReceivedChannel1)
-    // {
-    //     m_railcomData[m_railcomDetectionPort].lastChannelId = 0xFF;
-    //     m_railcomData[m_railcomDetectionPort].lastChannelData = 0xFF;
-    // }
+    return FeedbackDecoder::onRequestModulObjectConfig(id, tag);
+}
 
-    // channel 2
-    if (channel2.size > 0)
+bool RailcomDecoder::onCmdModulObjectConfig(uint16_t id, uint32_t tag, uint16_t value)
+{
+    const uint8_t port{static_cast<uint8_t>((tag & 0xFF) - 1)};
+    if ((id == m_networkId) && (railcomStatisticsTag == (tag & 0xFFFFFF00)) && (port < m_railcomStatistics.size()))
     {
-        if (AddressType::eLoco == m_addrReceived)
-        {
-            // find first NACK/ACK/BUSY => end of transmission
-            size_t endOfMessage{channel2.size};
-            for (size_t i = 0; i < channel2.size; i++)
-            {
-                uint8_t lastByte = channel2.bytes[i].data;
-                if ((0x40 == lastByte) || (0x41 == lastByte) || (0x42 == lastByte))
-                {
-                    // NACK, ACK, BUSY
-                    if (4 == channel2.bytes[i].direction)
-                    {
-                        m_channel2Direction = 0x10;
-                    }
-                    if (-4 == channel2.bytes[i].direction)
-                    {
-                        m_channel2Direction = 0x11;
-                    }
-                    std::array<uint16_t, 4> data = {1, 2, 3, 4};
-                    handleFoundLocoAddr(m_lastRailcomAddress, m_channel2Direction, Channel::eChannel2, data);
-                    endOfMessage = i;
-                    // no relevant data afterwards
-                    break;
-                }
-            }
-            // if (endOfMessage != channel2.size)
-            // {
-            //     // there could be some data
-            //     switch (endOfMessage)
-            //     {
-            //     case 0:
-            //     case 1:
-            //     case 2:
-            //     case 3:
-            //     case 4:
-            //     case 5:
-            //     case 6:
-            //     {
-            //         size_t i=0;
-            //         uint8_t railcomId{static_cast<uint8_t>((channel2.bytes[i].data >> 2u) & 0xFu)};
-            //         switch (railcomId)
-            //         {
-            //         case 0:
-            //         case 3:
-            //         case 7:
-            //         case 12:
-
-            //             if ((channel2.bytes[i + 1].startIndex - channel2.bytes[i].endIndex) < 6) // one byte commes direct after another
-            //             {
-            //                 uint8_t highByte{channel2.bytes[i].data};
-            //                 uint8_t lowByte{channel2.bytes[i + 1].data};
-            //                 uint8_t railcomId = (highByte >> 2) & 0xF;
-
-            //                 if (4 == channel2.bytes[i].direction)
-            //                 {
-            //                     m_channel2Direction = 0x10;
-            //                 }
-            //                 if (-4 == channel2.bytes[i].direction)
-            //                 {
-            //                     m_channel2Direction = 0x11;
-            //                 }
-            //                 std::array<uint16_t, 4> data = {1, 2, 3, 4};
-            //                 handleFoundLocoAddr(m_lastRailcomAddress, m_channel2Direction, Channel::eChannel2, data);
-            //                 break;
-            //             }
-            //             break;
-
-            //         default:
-            //             break;
-            //         }
-            //         break;
-            //     }
-            //     default:
-            //         break;
-            //     }
-            // }
-        }
-        else if (AddressType::eAcc == m_addrReceived)
-        {
-        }
+        m_railcomStatisticsReset[port] = m_railcomStatistics[port];
+        m_railcomStatistics[port].maxAnalysisCycles = 0;
+        if (m_railcomDebug)
+            ZCanInterfaceObserver::m_printFunc("Reset statistics of port %u\n", port);
+        return sendModuleObjectConfigAck(m_modulId, tag, 0);
     }
+    return FeedbackDecoder::onCmdModulObjectConfig(id, tag, value);
 }
 
-// retrive parameters of next byte in bit stream
-bool RailcomDecoder::getStartAndStopByteOfUart(bool *bitStreamIN1samplePer1us, size_t startIndex, size_t endIndex,
-                                               size_t *findStartIndex, size_t *findEndIndex)
+uint16_t RailcomDecoder::getRailcomStatistic(uint8_t port, uint8_t index)
 {
-    bool result{false};
-    // search for first high level
-    while (startIndex < endIndex)
+    const RailcomStatistics &statistics{m_railcomStatistics[port]};
+    const RailcomStatistics &reset{m_railcomStatisticsReset[port]};
+    uint32_t value{0};
+    switch (index)
     {
-        if (bitStreamIN1samplePer1us[startIndex] && !bitStreamIN1samplePer1us[startIndex + 1])
-        {
-            // negativ flank found
-            *findStartIndex = startIndex;
-
-            *findEndIndex = *findStartIndex + 37;
-            if (*findEndIndex <= endIndex)
-            {
-                result = true;
-            }
-            break;
-        }
-        startIndex++;
+    case 0:
+        value = statistics.cutouts - reset.cutouts;
+        break;
+    case 1:
+        value = statistics.startBits - reset.startBits;
+        break;
+    case 2:
+        value = statistics.invalidSymbols - reset.invalidSymbols;
+        break;
+    case 3:
+        value = statistics.channel1Addresses - reset.channel1Addresses;
+        break;
+    case 4:
+        value = statistics.channel2Acks - reset.channel2Acks;
+        break;
+    case 5:
+        value = statistics.channel2Nacks - reset.channel2Nacks;
+        break;
+    case 6:
+        // cycles are limited to 16 bits instead of wrapping around
+        value = (statistics.lastAnalysisCycles > 0xFFFF) ? 0xFFFF : statistics.lastAnalysisCycles;
+        break;
+    default:
+        value = (statistics.maxAnalysisCycles > 0xFFFF) ? 0xFFFF : statistics.maxAnalysisCycles;
+        break;
     }
-    return result;
+    return static_cast<uint16_t>(value);
 }
 
-void RailcomDecoder::handleBitStream(uint16_t dmaBufferIN1samplePer1us[], size_t length, RailcomChannelData &channel1, RailcomChannelData &channel2, uint16_t voltageOffset, uint16_t trackSetVoltage)
+void RailcomDecoder::countRailcomAnalysis(uint8_t port, const RailcomChannelData &channel, uint32_t cycles)
 {
-    std::array<bool, 512> bitStreamDataBuffer;
+    RailcomStatistics &statistics{m_railcomStatistics[port]};
+    statistics.startBits += channel.size + channel.framingErrors;
+    statistics.invalidSymbols += channel.framingErrors;
+    statistics.lastAnalysisCycles += cycles;
+    if (statistics.lastAnalysisCycles > statistics.maxAnalysisCycles)
+    {
+        statistics.maxAnalysisCycles = statistics.lastAnalysisCycles;
+    }
+}
+
+void RailcomDecoder::configRailcomCapture(uint8_t portsPerCapture, uint8_t samplePeriodINus)
+{
+    m_railcomPortsPerCapture = ((0 < portsPerCapture) && (portsPerCapture <= maxPortsPerCapture)) ? portsPerCapture : 1;
+    // uart bit of 4us has to be sampled at least twice
+    m_railcomSamplePeriodINus = ((0 < samplePeriodINus) && (samplePeriodINus <= 2)) ? samplePeriodINus : 1;
+#ifdef RAILCOM_TIMER_TRIGGER
+    // capture starts 50us after begin of cutout, channel 1 is sent from 80us up to 177us and channel 2 from 193us on
+    const size_t startChannel1INus{26};
+    const size_t endOfChannel1INus{131};
+    const size_t startChannel2INus{139};
+#else
+    // railcom pulse is at least 22us high while measurement was startet and last pulse has roundabout 40 seconds
+    const size_t startChannel1INus{15};
+    const size_t endOfChannel1INus{150}; // 170us (channel 1) minus 40us
+    const size_t startChannel2INus{150}; // 10u after end of channel 1
+#endif
+    m_railcomTiming.startChannel1 = startChannel1INus / m_railcomSamplePeriodINus;
+    m_railcomTiming.endOfChannel1 = endOfChannel1INus / m_railcomSamplePeriodINus;
+    m_railcomTiming.startChannel2 = startChannel2INus / m_railcomSamplePeriodINus;
+    m_railcomTiming.firstDataBit = 6 / m_railcomSamplePeriodINus;
+    m_railcomTiming.bitLength = 4 / m_railcomSamplePeriodINus;
+    m_railcomTiming.byteLength = 37 / m_railcomSamplePeriodINus;
+    m_railcomTiming.maxByteGap = 6 / m_railcomSamplePeriodINus;
+    // 400us of every port
+    m_railcomCaptureLength = 400 * m_railcomPortsPerCapture / m_railcomSamplePeriodINus;
+    if (m_railcomCaptureLength > m_railcomCaptures[0].samples.size())
+    {
+        m_railcomCaptureLength = m_railcomCaptures[0].samples.size();
+    }
+}
 
-    auto iteratorBit = bitStreamDataBuffer.begin();
+void RailcomDecoder::selectRailcomCapturePort(uint16_t samples[], uint8_t firstPort, uint8_t capturePort)
+{
+    m_railcomCapturePort = capturePort;
+    m_railcomAnalyzedPort = firstPort + capturePort;
+    m_railcomSamples = samples + capturePort;
+}
 
-    size_t maxIterator{length > bitStreamDataBuffer.size() ? bitStreamDataBuffer.size() : length};
+// analyze incoming bit stream of channel 1 for railcom data
+void RailcomDecoder::analyzeRailcomChannel1(RailcomChannelData &channel1, size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage, Channel1Result &result)
+{
+    // get possible uart bytes of serial communication including start position in stream and polarity to check direction
+    handleBitStream(0, length, voltageOffset, trackSetVoltage);
+    size_t endOfSearch{(length - 1) > m_railcomTiming.endOfChannel1 ? m_railcomTiming.endOfChannel1 : length - 1};
+    analyzeStream(channel1, m_railcomTiming.startChannel1, endOfSearch, voltageOffset);
 
-    for (size_t i = 0; i < length; i++)
+    result = Channel1Result();
+    result.framingError = (0 != channel1.framingErrors);
+    // run through analytics of every two bytes
+    for (size_t i = 0; ((i + 1) < channel1.size) && !result.locoFound; i++)
     {
-        if (dmaBufferIN1samplePer1us[i] > voltageOffset)
+        uint8_t highByte{channel1.bytes[i].data};
+        uint8_t lowByte{channel1.bytes[i + 1].data};
+        if ((highByte < 0x40) && (lowByte < 0x40))
         {
-            *iteratorBit = ((dmaBufferIN1samplePer1us[i] - voltageOffset) < trackSetVoltage);
+            if ((channel1.bytes[i + 1].startIndex - channel1.bytes[i].endIndex) < m_railcomTiming.maxByteGap) // one byte commes direct after another
+            {
+                if (!result.srqFound)
+                {
+                    // 12 bits without id, extended accessory flag and 11 bit address
+                    result.srqFound = true;
+                    result.srq = (highByte << 6) | lowByte;
+                }
+                RailcomPacket12Bit packet({highByte, lowByte});
+                if ((1 == packet.id) || (2 == packet.id))
+                {
+                    result.locoFound = true;
+                    result.locoId = packet.id;
+                    result.locoValue = packet.data[0];
+                    result.direction = getRailcomDirection(&channel1.bytes[i], 2, result.confidence);
+                }
+            }
         }
-        else
+    }
+}
+
+// act on channel 1 of m_railcomAnalyzedPort according to address type of dcc packet
+void RailcomDecoder::evaluateRailcomChannel1(const Channel1Result &result)
+{
+    m_channel1Direction = 0;
+    m_channel1Confidence = 0;
+    RailcomData &railcomData{m_railcomData[m_railcomAnalyzedPort]};
+    if ((AddressType::eAcc != m_addrReceived) && result.framingError && m_trackData[m_railcomAnalyzedPort].state)
+    {
+        // current flows, so start bits without valid code are answers of several locos at the same time
+        railcomData.collisionHits += (railcomData.collisionHits < m_railcomCollisionMaxHits) ? 1 : 0;
+    }
+
+    if (AddressType::eAcc == m_addrReceived)
+    {
+        // no loco answers after accessory packet, but accessory decoders send their service request
+        if (result.srqFound)
+        {
+            notifyAccessorySrq(m_railcomAnalyzedPort, result.srq & 0x07FF, 0x0800 == (result.srq & 0x0800));
+        }
+    }
+    else if (result.locoFound)
+    {
+        uint16_t locoAddr{0};
+        std::array<Channel1Votes, 2> &votes{railcomData.channel1Votes};
+        // a single wrong value does not throw away the other half of the address
+        voteChannel1(votes[result.locoId - 1], result.locoValue);
+        uint8_t addressHigh{0};
+        uint8_t addressLow{0};
+        if (getChannel1Value(votes[0], addressHigh) && getChannel1Value(votes[1], addressLow))
+        {
+            if (0x00 == (addressHigh & 0xB0))
+            {
+                // Base address CV1
+                locoAddr = addressLow & 0x7F;
+            }
+            else if (0x60 == addressHigh)
+            {
+                // Multiple Traction address CV19
+                locoAddr = addressLow & 0x7F;
+            }
+            else if (0x80 == (addressHigh & 0xC0))
+            {
+                // Extended address CV17 + CV18
+                locoAddr = ((addressHigh & 0x3F) << 8) | addressLow;
+            }
+        }
+
+        m_channel1Direction = result.direction;
+        m_channel1Confidence = result.confidence;
+
+        if (!result.framingError && (0 != railcomData.collisionHits))
+        {
+            railcomData.collisionHits--;
+        }
+        if ((result.framingError || hasChannel1Collision(m_railcomAnalyzedPort)) && !isRailcomAddrKnown(m_railcomAnalyzedPort, locoAddr))
+        {
+            // address may be mixed up of ids of several locos, so it is only refreshed
+            locoAddr = 0;
+        }
+
+        if (0 != locoAddr)
+        {
+            m_railcomStatistics[m_railcomAnalyzedPort].channel1Addresses++;
+        }
+        std::array<uint16_t, 4> data = {1, addressHigh, 2, addressLow};
+        handleFoundLocoAddr(locoAddr, m_channel1Direction, m_channel1Confidence, Channel::eChannel1, data);
+    }
+}
+
+bool RailcomDecoder::notifyAccessorySrq(uint8_t port, uint16_t accAddr, bool extended)
+{
+    RailcomData &data{m_railcomData[port]};
+    const uint32_t currentTimeINms{millis()};
+    if ((accAddr == data.srqAddress) && ((currentTimeINms - data.srqTimeINms) < m_srqRepeatINms))
+    {
+        return false;
+    }
+    if (m_railcomDebug)
+    {
+        m_printFunc("SRQ 0x%X %u %u\n", accAddr, extended, port);
+    }
+    data.srqAddress = accAddr;
+    data.srqTimeINms = currentTimeINms;
+    return sendAccessoryDataEvt(m_modulId, port, 0x34, accAddr, extended ? 1 : 0);
+}
+
+void RailcomDecoder::configChannel1Voting(uint8_t threshold, uint8_t maxHits)
+{
+    m_channel1MaxHits = (0 < maxHits) ? maxHits : 1;
+    m_channel1Threshold = ((0 < threshold) && (threshold <= m_channel1MaxHits)) ? threshold : m_channel1MaxHits;
+}
+
+void RailcomDecoder::voteChannel1(Channel1Votes &votes, uint8_t value)
+{
+    Channel1Candidate *match{nullptr};
+    for (Channel1Candidate &candidate : votes)
+    {
+        if ((0 != candidate.hits) && (value == candidate.value))
+        {
+            match = &candidate;
+        }
+    }
+    for (Channel1Candidate &candidate : votes)
+    {
+        if ((&candidate != match) && (0 != candidate.hits))
+        {
+            candidate.hits--;
+        }
+    }
+    if (nullptr != match)
+    {
+        if (match->hits < m_channel1MaxHits)
+        {
+            match->hits++;
+        }
+    }
+    else
+    {
+        for (Channel1Candidate &candidate : votes)
         {
-            *iteratorBit = ((voltageOffset - dmaBufferIN1samplePer1us[i]) < trackSetVoltage);
+            if (0 == candidate.hits)
+            {
+                candidate.value = value;
+                candidate.hits = 1;
+                break;
+            }
         }
-        iteratorBit++;
     }
+}
 
-    bool *bitStreamIN1samplePer1us{bitStreamDataBuffer.begin()};
+bool RailcomDecoder::getChannel1Value(const Channel1Votes &votes, uint8_t &value)
+{
+    const Channel1Candidate &first{votes[0]};
+    const Channel1Candidate &second{votes[1]};
+    const Channel1Candidate &best{(first.hits >= second.hits) ? first : second};
+    const Channel1Candidate &other{(first.hits >= second.hits) ? second : first};
+    if ((best.hits >= m_channel1Threshold) && (best.hits > other.hits))
+    {
+        value = best.value;
+        return true;
+    }
+    return false;
+}
 
-    auto analyzeStream = [this, &bitStreamIN1samplePer1us, &voltageOffset](RailcomChannelData &channel, size_t startOfSearch, size_t endOfSearch)
+void RailcomDecoder::trackRailcomIdleValue(size_t startIndex, size_t endIndex)
+{
+    // samples of a run are far away from edges of uart, so they are not part of a transition
+    const BitStream &bitStream{m_bitStream[m_railcomCapturePort]};
+    uint32_t idleSum{0};
+    size_t numberOfSamples{0};
+    for (size_t index = (startIndex + 31) & ~static_cast<size_t>(31); (index + 32) <= endIndex; index += 32)
+    {
+        if (0xFFFFFFFFu == bitStream.window(index))
+        {
+            for (size_t i = index; i < (index + 32); i++)
+            {
+                idleSum += m_railcomSamples[i * m_railcomPortsPerCapture];
+            }
+            numberOfSamples += 32;
+        }
+    }
+    if (0 != numberOfSamples)
     {
-        size_t startIndex{0};
-        size_t endIndex{0};
-        uint8_t numberOfBytes{0};
+        trackVoltageOffset(m_railcomAnalyzedPort, idleSum / numberOfSamples);
+    }
+}
+
+bool RailcomDecoder::hasChannel2Data(size_t length)
+{
+    size_t startIndex{0};
+    return m_bitStream[m_railcomCapturePort].findFallingEdge(m_railcomTiming.startChannel2, length - 1, startIndex);
+}
 
-        while (RailcomDecoder::getStartAndStopByteOfUart(bitStreamIN1samplePer1us, startOfSearch, endOfSearch, &startIndex, &endIndex))
+// analyze incoming bit stream of channel 2 for railcom data and act accordingly
+void RailcomDecoder::analyzeRailcomChannel2(RailcomChannelData &channel2, size_t startIndex, size_t length, uint16_t voltageOffset, uint16_t trackSetVoltage)
+{
+    m_channel2Direction = 0;
+    m_channel2Confidence = 0;
+    // samples before startIndex were already sliced for channel 1
+    handleBitStream(startIndex, length, voltageOffset, trackSetVoltage);
+    analyzeStream(channel2, m_railcomTiming.startChannel2, length - 1, voltageOffset);
+    for (size_t i = 0; i < channel2.size; i++)
+    {
+        m_railcomStatistics[m_railcomAnalyzedPort].channel2Acks += (RailcomCodec::ack == channel2.bytes[i].data) ? 1 : 0;
+        m_railcomStatistics[m_railcomAnalyzedPort].channel2Nacks += (RailcomCodec::nack == channel2.bytes[i].data) ? 1 : 0;
+    }
+
+    if (channel2.size > 0)
+    {
+        if (AddressType::eLoco == m_addrReceived)
         {
-            // found
-            uint8_t dataByte{0};
-            uint8_t bit{0};
-            int8_t directionCount{0};
-            channel.bytes[numberOfBytes].startIndex = startIndex;
-            channel.bytes[numberOfBytes].endIndex = endIndex;
-            startIndex += 6; // add 6 bits to get to middle of first data bit
-            size_t endOfByte{startIndex + 28};
-            while (endOfByte >= startIndex)
+            std::array<Channel2Datagram, maxChannel2Datagrams> datagrams;
+            size_t numberOfDatagrams{parseChannel2(channel2, datagrams, channel2Formats)};
+            for (size_t i = 0; i < numberOfDatagrams; i++)
             {
-                if (!bitStreamIN1samplePer1us[startIndex])
+                // every datagram is an answer of addressed loco
+                std::array<uint16_t, 4> data = {datagrams[i].id, static_cast<uint16_t>(datagrams[i].value & 0xFFFF), static_cast<uint16_t>(datagrams[i].value >> 16), 0};
+                handleFoundLocoAddr(m_lastRailcomAddress, datagrams[i].direction, datagrams[i].confidence, Channel::eChannel2, data);
+                // telemetry values of dyn are pushed on change only
+                bool telemetry{(Channel2Type::eDyn == datagrams[i].type) &&
+                               updateTelemetry(m_railcomAnalyzedPort, m_lastRailcomAddress, datagrams[i].value & 0x3F, (datagrams[i].value >> 6) & 0xFF)};
+                if (m_modulConfig.sendChannel2Data && !telemetry)
                 {
-                    // zero bits means that value is higher or lower than idle value
-                    if (m_dmaBufferIN1samplePer1us[startIndex] > voltageOffset)
-                    {
-                        // there will always be four zeros if transmission is correct
-                        // TODO
-                        directionCount++;
-                    }
-                    else
-                    {
-                        // TODO
-                        directionCount--;
-                    }
+                    notifyChannel2Datagram(m_railcomAnalyzedPort, m_lastRailcomAddress, channel2Formats[datagrams[i].id].accessoryDataType, datagrams[i]);
                 }
-                dataByte |= ((bitStreamIN1samplePer1us[startIndex] ? 1 : 0) << bit++);
-                startIndex += 4;
             }
-            if (8 == bit)
+            // find first NACK/ACK/BUSY => end of transmission
+            for (size_t i = 0; i < channel2.size; i++)
             {
-                // from 4 to 8 code
-                dataByte = encode8to4[dataByte];
-                switch (dataByte)
+                uint8_t lastByte = channel2.bytes[i].data;
+                if ((RailcomCodec::nack == lastByte) || (RailcomCodec::ack == lastByte) || (RailcomCodec::busy == lastByte))
                 {
-                case 0xEE:
-                case 0xFF:
-                    // not used => error
-                    break;
-                default:
-                    channel.bytes[numberOfBytes].data = dataByte;
-                    channel.bytes[numberOfBytes].direction = directionCount;
-                    channel.bytes[numberOfBytes].valid = true;
-                    numberOfBytes++;
+                    // NACK, ACK, BUSY
+                    m_channel2Direction = getRailcomDirection(&channel2.bytes[i], 1, m_channel2Confidence);
+                    std::array<uint16_t, 4> data = {lastByte, 0, 0, 0};
+                    handleFoundLocoAddr(m_lastRailcomAddress, m_channel2Direction, m_channel2Confidence, Channel::eChannel2, data);
+                    // no relevant data afterwards
                     break;
                 }
             }
-            startOfSearch = endIndex;
         }
-        channel.size = numberOfBytes;
-    };
+        else if (AddressType::eAcc == m_addrReceived)
+        {
+            // status and error reports of addressed accessory decoder
+            std::array<Channel2Datagram, maxChannel2Datagrams> datagrams;
+            size_t numberOfDatagrams{parseChannel2(channel2, datagrams, accessoryChannel2Formats)};
+            for (size_t i = 0; (i < numberOfDatagrams) && m_modulConfig.sendChannel2Data; i++)
+            {
+                notifyChannel2Datagram(m_railcomAnalyzedPort, m_lastRailcomAddress, accessoryChannel2Formats[datagrams[i].id].accessoryDataType, datagrams[i]);
+            }
+        }
+    }
+}
 
-    // railcom pulse is at least 22us high while measurement was startet and last pulse has roundabout 40 seconds
-    const size_t endOfChannel1{150}; // 170us (channel 1) minus 40us
-    size_t endOfSearch{(length - 1) > endOfChannel1 ? endOfChannel1 : length - 1};
-    analyzeStream(channel1, 15, endOfSearch);
+size_t RailcomDecoder::parseChannel2(const RailcomChannelData &channel2, std::array<Channel2Datagram, maxChannel2Datagrams> &datagrams,
+                                     const std::array<Channel2Format, 16> &formats)
+{
+    size_t numberOfDatagrams{0};
+    size_t index{0};
+    while ((index < channel2.size) && (numberOfDatagrams < datagrams.size()))
+    {
+        const RailcomByte &first{channel2.bytes[index]};
+        if (first.data >= 0x40)
+        {
+            // NACK, ACK or BUSY ends transmission
+            break;
+        }
+        uint8_t id{static_cast<uint8_t>(first.data >> 2)};
+        const Channel2Format &format{formats[id]};
+        // all symbols of datagram follow directly with same polarity
+        bool complete{(0 != format.numberOfSymbols) && ((index + format.numberOfSymbols) <= channel2.size)};
+        for (size_t i = index + 1; complete && (i < (index + format.numberOfSymbols)); i++)
+        {
+            complete = (channel2.bytes[i].data < 0x40) && ((channel2.bytes[i].polarity > 0) == (first.polarity > 0)) &&
+                       ((channel2.bytes[i].startIndex - channel2.bytes[i - 1].endIndex) < m_railcomTiming.maxByteGap);
+        }
+        if (!complete)
+        {
+            // unknown id or broken datagram, resynchronize on next symbol
+            index++;
+            continue;
+        }
+        Channel2Datagram &datagram{datagrams[numberOfDatagrams]};
+        const RailcomByte *bytes{&channel2.bytes[index]};
+        datagram.type = format.type;
+        datagram.id = id;
+        datagram.direction = getRailcomDirection(bytes, format.numberOfSymbols, datagram.confidence);
+        switch (format.numberOfSymbols)
+        {
+        case 2:
+        {
+            RailcomPacket12Bit packet({bytes[0].data, bytes[1].data});
+            datagram.value = packet.data[0];
+            break;
+        }
+        case 3:
+        {
+            RailcomPacket18Bit packet({bytes[0].data, bytes[1].data, bytes[2].data});
+            datagram.value = (static_cast<uint32_t>(packet.data[1]) << 8) | packet.data[0];
+            break;
+        }
+        case 4:
+        {
+            RailcomPacket24Bit packet({bytes[0].data, bytes[1].data, bytes[2].data, bytes[3].data});
+            datagram.value = (static_cast<uint32_t>(packet.data[2]) << 16) | (static_cast<uint32_t>(packet.data[1]) << 8) | packet.data[0];
+            break;
+        }
+        default:
+        {
+            RailcomPacket36Bit packet({bytes[0].data, bytes[1].data, bytes[2].data, bytes[3].data, bytes[4].data, bytes[5].data});
+            datagram.value = (static_cast<uint32_t>(packet.data[3]) << 24) | (static_cast<uint32_t>(packet.data[2]) << 16) |
+                             (static_cast<uint32_t>(packet.data[1]) << 8) | packet.data[0];
+            break;
+        }
+        }
+        numberOfDatagrams++;
+        index += format.numberOfSymbols;
+    }
+    return numberOfDatagrams;
+}
 
-    const size_t startChannel2{150}; // 10u after end of channel 1
-    analyzeStream(channel2, startChannel2, length - 1);
+bool RailcomDecoder::notifyChannel2Datagram(uint8_t port, uint16_t address, uint8_t type, const Channel2Datagram &datagram)
+{
+    bool result{false};
+    if (0 == type)
+    {
+        // datagram is not forwarded
+        return result;
+    }
+    switch (datagram.type)
+    {
+    case Channel2Type::ePom:
+        // cv value
+        result = sendAccessoryDataEvt(m_modulId, port, type, address, datagram.value & 0xFF);
+        break;
+    case Channel2Type::eStat4:
+    case Channel2Type::eStat1:
+    case Channel2Type::eTime:
+    case Channel2Type::eError:
+        // status, switching time or error of accessory decoder
+        result = sendAccessoryDataEvt(m_modulId, port, type, address, datagram.value & 0xFF);
+        break;
+    case Channel2Type::eExt:
+        // type and position of location information
+        result = sendAccessoryDataEvt(m_modulId, port, type, address, datagram.value & 0x3FFF);
+        break;
+    case Channel2Type::eDyn:
+        // subindex in high byte and value in low byte
+        result = sendAccessoryDataEvt(m_modulId, port, type, address, ((datagram.value & 0x3F) << 8) | ((datagram.value >> 6) & 0xFF));
+        break;
+#ifdef RAILCOM_TIMER_TRIGGER
+    case Channel2Type::eXpom:
+        // four cv values with sequence number of id in bits 14 and 15 of address, first cv is high byte of second message
+        result = sendAccessoryDataEvt(m_modulId, port, type, address | ((datagram.id - 8) << 14), datagram.value & 0xFFFF);
+        result &= sendAccessoryDataEvt(m_modulId, port, type + 1, address | ((datagram.id - 8) << 14), datagram.value >> 16);
+        break;
+#endif
+    default:
+        break;
+    }
+    return result;
 }
 
-void RailcomDecoder::handleFoundLocoAddr(uint16_t locoAddr, uint16_t direction, Channel channel, std::array<uint16_t, 4> &railcomData)
+bool RailcomDecoder::updateTelemetry(uint8_t port, uint16_t locoAddr, uint8_t subindex, uint8_t value)
+{
+    uint16_t telemetryValue{value};
+    if (1 == subindex)
+    {
+        // second part of speed above 255
+        subindex = 0;
+        telemetryValue += 256;
+    }
+    uint8_t index{0};
+    while ((index < telemetryFormats.size()) && (subindex != telemetryFormats[index].subindex))
+    {
+        index++;
+    }
+    if ((index >= telemetryFormats.size()) || (0 == locoAddr))
+    {
+        return false;
+    }
+    // entry of loco, free entry or entry which was not updated for the longest time
+    const uint32_t currentTimeINms{millis()};
+    LocoTelemetry *entry{nullptr};
+    for (auto &telemetry : m_locoTelemetry)
+    {
+        if (locoAddr == telemetry.address)
+        {
+            entry = &telemetry;
+            break;
+        }
+        if ((nullptr == entry) || ((0 != entry->address) &&
+                                   ((0 == telemetry.address) || (telemetry.lastUpdateTimeINms < entry->lastUpdateTimeINms))))
+        {
+            entry = &telemetry;
+        }
+    }
+    if (locoAddr != entry->address)
+    {
+        *entry = LocoTelemetry();
+        entry->address = locoAddr;
+    }
+    entry->port = port;
+    entry->lastUpdateTimeINms = currentTimeINms;
+    entry->values[index].value = telemetryValue;
+    entry->values[index].received = true;
+    checkTelemetryValue(*entry, index, currentTimeINms);
+    return true;
+}
+
+bool RailcomDecoder::checkTelemetryValue(LocoTelemetry &telemetry, uint8_t index, uint32_t currentTimeINms)
+{
+    TelemetryValue &value{telemetry.values[index]};
+    const TelemetryFormat &format{telemetryFormats[index]};
+    if (!m_modulConfig.sendChannel2Data || !value.received || (value.reported && (value.value == value.reportedValue)))
+    {
+        return false;
+    }
+    const uint32_t elapsedINms{currentTimeINms - value.lastReportTimeINms};
+    const uint16_t change = (value.value > value.reportedValue) ? (value.value - value.reportedValue) : (value.reportedValue - value.value);
+    if (value.reported && (elapsedINms < format.maxIntervalINms) && ((change < format.deadband) || (elapsedINms < format.minIntervalINms)))
+    {
+        return false;
+    }
+    uint16_t value2{value.value};
+    if (26 == format.subindex)
+    {
+        // temperature in degree celsius
+        value2 = static_cast<uint16_t>(static_cast<int16_t>(value.value) - 50);
+    }
+    else if (8 <= format.subindex)
+    {
+        // number of container in high byte
+        value2 = ((format.subindex - 7) << 8) | value.value;
+    }
+    if (sendAccessoryDataEvt(m_modulId, telemetry.port, format.accessoryDataType, telemetry.address, value2))
+    {
+        value.reportedValue = value.value;
+        value.lastReportTimeINms = currentTimeINms;
+        value.reported = true;
+        return true;
+    }
+    return false;
+}
+
+void RailcomDecoder::cyclicTelemetryCheck()
+{
+    LocoTelemetry &telemetry{m_locoTelemetry[m_cyclicTelemetryCheckIndex]};
+    if (0 != telemetry.address)
+    {
+        const uint32_t currentTimeINms{millis()};
+        if ((m_railcomDataTimeoutINms + telemetry.lastUpdateTimeINms) < currentTimeINms)
+        {
+            telemetry.address = 0;
+        }
+        else
+        {
+            for (uint8_t index = 0; index < telemetry.values.size(); index++)
+            {
+                checkTelemetryValue(telemetry, index, currentTimeINms);
+            }
+        }
+    }
+    m_cyclicTelemetryCheckIndex++;
+    if (m_cyclicTelemetryCheckIndex >= m_locoTelemetry.size())
+    {
+        m_cyclicTelemetryCheckIndex = 0;
+    }
+}
+
+// retrive parameters of next byte in bit stream
+bool RailcomDecoder::getStartAndStopByteOfUart(const BitStream &bitStream, size_t startIndex, size_t endIndex,
+                                               size_t *findStartIndex, size_t *findEndIndex)
+{
+    bool result{false};
+    // search for first negativ flank
+    if (bitStream.findFallingEdge(startIndex, endIndex, *findStartIndex))
+    {
+        *findEndIndex = *findStartIndex + m_railcomTiming.byteLength;
+        if (*findEndIndex <= endIndex)
+        {
+            result = true;
+        }
+    }
+    return result;
+}
+
+void RailcomDecoder::handleBitStream(size_t startIndex, size_t endIndex, uint16_t voltageOffset, uint16_t trackSetVoltage)
+{
+    uint16_t &threshold{m_railcomSliceThreshold[m_railcomCapturePort]};
+    if (0 == startIndex)
+    {
+        threshold = 0;
+    }
+    if (0 == threshold)
+    {
+        // railcom current differs by decoder and feeder, so level of zero bits is taken from cutout
+        size_t startOfSearch{(startIndex > m_railcomTiming.startChannel1) ? startIndex : m_railcomTiming.startChannel1};
+        threshold = measureRailcomStartBit(startOfSearch, endIndex, voltageOffset) / 2;
+    }
+    m_bitStream[m_railcomCapturePort].slice(m_railcomSamples, startIndex, endIndex, voltageOffset, (0 != threshold) ? threshold : trackSetVoltage,
+                                            m_railcomPortsPerCapture);
+}
+
+uint16_t RailcomDecoder::measureRailcomStartBit(size_t startIndex, size_t endIndex, uint16_t voltageOffset)
+{
+    // edges are skipped, so first quarter of start bit is not measured
+    const size_t firstSample{m_railcomTiming.bitLength / 4};
+    for (size_t index = startIndex; (index + m_railcomTiming.bitLength) <= endIndex; index++)
+    {
+        int32_t deviation{static_cast<int32_t>(m_railcomSamples[index * m_railcomPortsPerCapture]) - static_cast<int32_t>(voltageOffset)};
+        if ((deviation < m_railcomMinBitVoltage) && (-deviation < m_railcomMinBitVoltage))
+        {
+            continue;
+        }
+        // every sample of start bit has same polarity and at least minimum current, so single spikes are no start bit
+        uint32_t sum{0};
+        size_t sample{index + firstSample};
+        for (; sample < (index + m_railcomTiming.bitLength); sample++)
+        {
+            int32_t value{static_cast<int32_t>(m_railcomSamples[sample * m_railcomPortsPerCapture]) - static_cast<int32_t>(voltageOffset)};
+            value = (deviation > 0) ? value : -value;
+            if (value < m_railcomMinBitVoltage)
+            {
+                break;
+            }
+            sum += value;
+        }
+        if ((index + m_railcomTiming.bitLength) == sample)
+        {
+            return sum / (m_railcomTiming.bitLength - firstSample);
+        }
+    }
+    return 0;
+}
+
+void RailcomDecoder::analyzeStream(RailcomChannelData &channel, size_t startOfSearch, size_t endOfSearch, uint16_t voltageOffset)
+{
+    size_t startIndex{0};
+    size_t endIndex{0};
+    uint8_t numberOfBytes{0};
+
+    const BitStream &bitStream{m_bitStream[m_railcomCapturePort]};
+    while ((numberOfBytes < channel.bytes.size()) && getStartAndStopByteOfUart(bitStream, startOfSearch, endOfSearch, &startIndex, &endIndex))
+    {
+        // found
+        uint8_t dataByte{0};
+        RailcomByte &byte{channel.bytes[numberOfBytes]};
+        byte.startIndex = startIndex;
+        byte.endIndex = endIndex;
+        byte.polarity = 0;
+        byte.magnitude = 0;
+        startIndex += m_railcomTiming.firstDataBit; // get to middle of first data bit
+        // zero bits means that value is higher or lower than idle value, start bit is always zero
+        integrateZeroBit(byte, startIndex - m_railcomTiming.bitLength, voltageOffset);
+        // 7 bit lengths from middle of first data bit up to middle of last data bit, first data bit is MSB
+        uint32_t samples{bitStream.window(startIndex)};
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            if (0 != (samples & 0x80000000u))
+            {
+                dataByte |= (1 << bit);
+            }
+            else
+            {
+                integrateZeroBit(byte, startIndex, voltageOffset);
+            }
+            samples <<= m_railcomTiming.bitLength;
+            startIndex += m_railcomTiming.bitLength;
+        }
+        // from 4 to 8 code
+        dataByte = RailcomCodec::encode8to4[dataByte];
+        switch (dataByte)
+        {
+        case RailcomCodec::unused:
+        case RailcomCodec::invalid:
+            // not used => error
+            channel.framingErrors++;
+            break;
+        default:
+            byte.data = dataByte;
+            byte.valid = true;
+            numberOfBytes++;
+            break;
+        }
+        startOfSearch = endIndex;
+    }
+    channel.size = numberOfBytes;
+}
+
+void RailcomDecoder::integrateZeroBit(RailcomByte &byte, size_t middleIndex, uint16_t voltageOffset)
+{
+    // middle half of bit, at least one sample
+    const size_t firstIndex{middleIndex - m_railcomTiming.bitLength / 4};
+    for (size_t index = firstIndex; index < (firstIndex + m_railcomTiming.bitLength / 2); index++)
+    {
+        int32_t value{static_cast<int32_t>(m_railcomSamples[index * m_railcomPortsPerCapture]) - static_cast<int32_t>(voltageOffset)};
+        byte.polarity += value;
+        byte.magnitude += (value > 0) ? value : -value;
+    }
+}
+
+uint16_t RailcomDecoder::getRailcomDirection(const RailcomByte *bytes, size_t numberOfBytes, uint8_t &confidence)
+{
+    int32_t polarity{0};
+    uint32_t magnitude{0};
+    for (size_t i = 0; i < numberOfBytes; i++)
+    {
+        polarity += bytes[i].polarity;
+        magnitude += bytes[i].magnitude;
+    }
+    if (0 == magnitude)
+    {
+        confidence = 0;
+        return 0;
+    }
+    // samples of other sign or near idle value reduce confidence
+    confidence = static_cast<uint8_t>((static_cast<uint32_t>((polarity > 0) ? polarity : -polarity) * 100) / magnitude);
+    if (confidence < m_directionMinConfidence)
+    {
+        return 0;
+    }
+    return (polarity > 0) ? 0x10 : 0x11;
+}
+
+void RailcomDecoder::handleFoundLocoAddr(uint16_t locoAddr, uint16_t direction, uint8_t confidence, Channel channel, std::array<uint16_t, 4> & /*railcomData*/)
 {
     if ((0 != locoAddr) && (255 != locoAddr))
     {
         bool addressFound{false};
-        for (auto &data : m_railcomData[m_railcomDetectionPort].railcomAddr)
+        for (auto &data : m_railcomData[m_railcomAnalyzedPort].railcomAddr)
         {
             if (locoAddr == data.address)
             {
                 addressFound = true;
-                if (direction != data.direction)
+                if (direction == data.direction)
+                {
+                    data.directionChanges = 0;
+                }
+                else if ((0 != direction) && ((0 == data.direction) || (++data.directionChanges >= m_directionChangeObservations)))
                 {
                     data.direction = direction;
+                    data.directionChanges = 0;
                     if (m_railcomDebug)
                     {
-                        m_printFunc("dir:0x%X 0x%X %d\n", locoAddr, direction, channel);
+                        m_printFunc("dir:0x%X 0x%X %u%% %d\n", locoAddr, direction, confidence, channel);
                     }
-                    notifyLocoInBlock(m_railcomDetectionPort, m_railcomData[m_railcomDetectionPort].railcomAddr);
+                    notifyLocoInBlock(m_railcomAnalyzedPort, m_railcomData[m_railcomAnalyzedPort].railcomAddr);
                 }
                 data.lastChangeTimeINms = millis();
+                updateLocoPortIndex(locoAddr, m_railcomAnalyzedPort);
                 break;
             }
         }
         if (!addressFound)
         {
             // value not in table, find a block for it. If full, ignore value
-            for (auto &data : m_railcomData[m_railcomDetectionPort].railcomAddr)
+            for (auto &data : m_railcomData[m_railcomAnalyzedPort].railcomAddr)
             {
                 if (0 == data.address)
                 {
                     data.address = locoAddr;
                     data.direction = direction;
+                    data.directionChanges = 0;
                     if (m_railcomDebug)
                     {
-                        m_printFunc("come:0x%X D:0x%X %d:%d\n", locoAddr, direction, m_railcomDetectionPort, channel);
+                        m_printFunc("come:0x%X D:0x%X %u%% %d:%d\n", locoAddr, direction, confidence, m_railcomAnalyzedPort, channel);
                         // m_printFunc("%x %x %x %x\n", railcomData[0], railcomData[1], railcomData[2], railcomData[3]);
                     }
-                    notifyLocoInBlock(m_railcomDetectionPort, m_railcomData[m_railcomDetectionPort].railcomAddr);
+                    notifyLocoInBlock(m_railcomAnalyzedPort, m_railcomData[m_railcomAnalyzedPort].railcomAddr);
                     data.lastChangeTimeINms = millis();
+                    updateLocoPortIndex(locoAddr, m_railcomAnalyzedPort);
                     break;
                 }
             }
@@ -635,6 +1561,85 @@ void RailcomDecoder::handleFoundLocoAddr(uint16_t locoAddr, uint16_t direction,
     }
 }
 
+uint8_t RailcomDecoder::findLocoPort(uint16_t locoAddr)
+{
+    for (auto &entry : m_locoPortIndex)
+    {
+        if (locoAddr == entry.address)
+        {
+            return entry.port;
+        }
+    }
+    return noRailcomPort;
+}
+
+bool RailcomDecoder::isRailcomAddrKnown(uint8_t port, uint16_t locoAddr)
+{
+    for (auto &data : m_railcomData[port].railcomAddr)
+    {
+        if ((0 != locoAddr) && (locoAddr == data.address))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RailcomDecoder::hasChannel1Collision(uint8_t port)
+{
+    return m_trackData[port].state && (m_railcomData[port].collisionHits >= m_railcomCollisionThreshold);
+}
+
+uint8_t RailcomDecoder::findCollisionPort()
+{
+    for (uint8_t i = 1; i <= m_trackData.size(); i++)
+    {
+        uint8_t port = (m_railcomCollisionPort + i) % m_trackData.size();
+        if (hasChannel1Collision(port))
+        {
+            m_railcomCollisionPort = port;
+            return port;
+        }
+    }
+    return noRailcomPort;
+}
+
+void RailcomDecoder::updateLocoPortIndex(uint16_t locoAddr, uint8_t port)
+{
+    LocoPort *freeEntry{nullptr};
+    for (auto &entry : m_locoPortIndex)
+    {
+        if (locoAddr == entry.address)
+        {
+            // loco moved to port
+            entry.port = port;
+            return;
+        }
+        if ((nullptr == freeEntry) && (0 == entry.address))
+        {
+            freeEntry = &entry;
+        }
+    }
+    // index has an entry for every address of m_railcomData
+    if (nullptr != freeEntry)
+    {
+        freeEntry->address = locoAddr;
+        freeEntry->port = port;
+    }
+}
+
+void RailcomDecoder::removeFromLocoPortIndex(uint16_t locoAddr, uint8_t port)
+{
+    for (auto &entry : m_locoPortIndex)
+    {
+        if ((locoAddr == entry.address) && (port == entry.port))
+        {
+            entry.address = 0;
+            break;
+        }
+    }
+}
+
 bool RailcomDecoder::notifyLocoInBlock(uint8_t port, std::array<RailcomAddr, 4> railcomAddr)
 {
     bool result = sendAccessoryDataEvt(m_modulId, port, 0x11,
@@ -644,338 +1649,61 @@ bool RailcomDecoder::notifyLocoInBlock(uint8_t port, std::array<RailcomAddr, 4>
     return result;
 }
 
-uint8_t RailcomDecoder::encode4to8[] = {
-    0b10101100,
-    0b10101010,
-    0b10101001,
-    0b10100101,
-    0b10100011,
-    0b10100110,
-    0b10011100,
-    0b10011010,
-    0b10011001,
-    0b10010101,
-    0b10010011,
-    0b10010110,
-    0b10001110,
-    0b10001101,
-    0b10001011,
-    0b10110001,
-    0b10110010,
-    0b10110100,
-    0b10111000,
-    0b01110100,
-    0b01110010,
-    0b01101100,
-    0b01110010,
-    0b01101100,
-    0b01101010,
-    0b01101001,
-    0b01100101,
-    0b01100011,
-    0b01100110,
-    0b01011100,
-    0b01011010,
-    0b01011001,
-    0b01010101,
-    0b01010011,
-    0b01010110,
-    0b01001110,
-    0b01001101,
-    0b01001011,
-    0b01000111,
-    0b01110001,
-    0b11101000,
-    0b11100100,
-    0b11100010,
-    0b11010001,
-    0b11001001,
-    0b11000101,
-    0b11011000,
-    0b11010100,
-    0b11010010,
-    0b11001010,
-    0b11000110,
-    0b11001100,
-    0b01111000,
-    0b00010111,
-    0b00011011,
-    0b00011101,
-    0b00011110,
-    0b00101110,
-    0b00110110,
-    0b00111010,
-    0b00100111,
-    0b00101011,
-    0b00101101,
-    0b00110101,
-    0b00111001,
-    0b00110011, // 0x3F
-
-    0b00001111, // NACK
-    0b11110000, // ACK
-    0b11100001, // BUSY
-    0b11000011, // not used
-    0b10000111, // not used
-    0b00111100  // not used
-};
-// NACK 0x40
-// ACK 0x41
-// Busy 0x42
-uint8_t RailcomDecoder::encode8to4[] = {
-    0xFF, // invalid 0b00000000
-    0xFF, // invalid 0b00000001
-    0xFF, // invalid 0b00000010
-    0xFF, // invalid 0b00000011
-    0xFF, // invalid 0b00000100
-    0xFF, // invalid 0b00000101
-    0xFF, // invalid 0b00000110
-    0xFF, // invalid 0b00000111
-    0xFF, // invalid 0b00001000
-    0xFF, // invalid 0b00001001
-    0xFF, // invalid 0b00001010
-    0xFF, // invalid 0b00001011
-    0xFF, // invalid 0b00001100
-    0xFF, // invalid 0b00001101
-    0xFF, // invalid 0b00001110
-    0x40, // NACK 15 0b00001111
-    0xFF, // invalid 0b00010000
-    0xFF, // invalid 0b00010001
-    0xFF, // invalid 0b00010010
-    0xFF, // invalid 0b00010011
-    0xFF, // invalid 0b00010100
-    0xFF, // invalid 0b00010101
-    0xFF, // invalid 0b00010110
-    0x33, // 0x17    0b00010111
-    0xFF, // invalid 0b00011000
-    0xFF, // invalid 0b00011001
-    0xFF, // invalid 0b00011010
-    0x34, // 0x1B    0b00011011
-    0xFF, // invalid 0b00011100
-    0x35, // 0x1D    0b00011101
-    0x36, // 0x1E    0b00011110
-    0xFF, // invalid 0b00011111
-    0xFF, // invalid 0b00100000
-    0xFF, // invalid 0b00100001
-    0xFF, // invalid 0b00100010
-    0xFF, // invalid 0b00100011
-    0xFF, // invalid 0b00100100
-    0xFF, // invalid 0b00100101
-    0xFF, // invalid 0b00100110
-    0x3A, // 0x27    0b00100111
-    0xFF, // invalid 0b00101000
-    0xFF, // invalid 0b00101001
-    0xFF, // invalid 0b00101010
-    0x3B, // 0x2B    0b00101011
-    0xFF, // invalid 0b00101100
-    0x3C, // invalid 0b00101101
-    0x37, // 0x2E    0b00101110
-    0xFF, // invalid 0b00101111
-    0xFF, // invalid 0b00110000
-    0xFF, // invalid 0b00110001
-    0xFF, // invalid 0b00110010
-    0x3F, // 0x33    0b00110011
-    0xFF, // invalid 0b00110100
-    0x3D, // 0x35    0b00110101
-    0x38, // 0x36    0b00110110
-    0xFF, // invalid 0b00110111
-    0xFF, // invalid 0b00111000
-    0x3E, // 0x39    0b00111001
-    0x39, // 0x3A    0b00111010
-    0xFF, // invalid 0b00111011
-    0xEE, // not use 0b00111100
-    0xFF, // invalid 0b00111101
-    0xFF, // invalid 0b00111110
-    0xFF, // invalid 0b00111111
-    0xFF, // invalid 0b01000000
-    0xFF, // invalid 0b01000001
-    0xFF, // invalid 0b01000010
-    0xFF, // invalid 0b01000011
-    0xFF, // invalid 0b01000100
-    0xFF, // invalid 0b01000101
-    0xFF, // invalid 0b01000110
-    0x24, // 0x47    0b01000111
-    0xFF, // invalid 0b01001000
-    0xFF, // invalid 0b01001001
-    0xFF, // invalid 0b01001010
-    0x23, // 0x4B    0b01001011
-    0xFF, // invalid 0b01001100
-    0x22, // 0x4D    0b01001101
-    0x21, // 0x4E    0b01001110
-    0xFF, // invalid 0b01001111
-    0xFF, // invalid 0b01010000
-    0xFF, // invalid 0b01010001
-    0xFF, // invalid 0b01010010
-    0x1F, // 0x53    0b01010011
-    0xFF, // invalid 0b01010100
-    0x1E, // 0x55    0b01010101
-    0x20, // 0x56    0b01010110
-    0xFF, // invalid 0b01010111
-    0xFF, // invalid 0b01011000
-    0x1D, // 0x59    0b01011001
-    0x1C, // 0x5A    0b01011010
-    0xFF, // invalid 0b01011011
-    0x1B, // 0x5C    0b01011100
-    0xFF, // invalid 0b01011101
-    0xFF, // invalid 0b01011110
-    0xFF, // invalid 0b01011111
-    0xFF, // invalid 0b01100000
-    0xFF, // invalid 0b01100001
-    0xFF, // invalid 0b01100010
-    0x19, // 0x63    0b01100011
-    0xFF, // invalid 0b01100100
-    0x18, // 0x65    0b01100101
-    0x1A, // 0x66    0b01100110
-    0xFF, // invalid 0b01100111
-    0xFF, // invalid 0b01101000
-    0x17, // 0x69    0b01101001
-    0x16, // 0x6A    0b01101010
-    0xFF, // invalid 0b01101011
-    0x15, // 0x6C    0b01101100
-    0xFF, // invalid 0b01101101
-    0xFF, // invalid 0b01101110
-    0xFF, // invalid 0b01101111
-    0xFF, // invalid 0b01110000
-    0x25, // 0x71    0b01110001
-    0x14, // 0x72    0b01110010
-    0xFF, // invalid 0b01110011
-    0x13, // 0x74    0b01110100
-    0xFF, // invalid 0b01110101
-    0xFF, // invalid 0b01110110
-    0xFF, // invalid 0b01110111
-    0x32, // 0x78    0b01111000
-    0xFF, // invalid 0b01111001
-    0xFF, // invalid 0b01111010
-    0xFF, // invalid 0b01111011
-    0xFF, // invalid 0b01111100
-    0xFF, // invalid 0b01111101
-    0xFF, // invalid 0b01111110
-    0xFF, // invalid 0b01111111
-    0xFF, // invalid 0b10000000
-    0xFF, // invalid 0b10000001
-    0xFF, // invalid 0b10000010
-    0xFF, // invalid 0b10000011
-    0xFF, // invalid 0b10000100
-    0xFF, // invalid 0b10000101
-    0xFF, // invalid 0b10000110
-    0xEE, // not use 0b10000111
-    0xFF, // invalid 0b10001000
-    0xFF, // invalid 0b10001001
-    0xFF, // invalid 0b10001010
-    0x0E, // 0x8B    0b10001011
-    0xFF, // invalid 0b10001100
-    0x0D, // 0x8D    0b10001101
-    0x0C, // 0x8E    0b10001110
-    0xFF, // invalid 0b10001111
-    0xFF, // invalid 0b10010000
-    0xFF, // invalid 0b10010001
-    0xFF, // invalid 0b10010010
-    0x0A, // 0x93    0b10010011
-    0xFF, // invalid 0b10010100
-    0x09, // 0x95    0b10010101
-    0x0B, // 0x96    0b10010110
-    0xFF, // invalid 0b10010111
-    0xFF, // invalid 0b10011000
-    0x08, // 0x99    0b10011001
-    0x07, // 0x9A    0b10011010
-    0xFF, // invalid 0b10011011
-    0x06, // 0x9C    0b10011100
-    0xFF, // invalid 0b10011101
-    0xFF, // invalid 0b10011110
-    0xFF, // invalid 0b10011111
-    0xFF, // invalid 0b10100000
-    0xFF, // invalid 0b10100001
-    0xFF, // invalid 0b10100010
-    0x04, // 0xA3    0b10100011
-    0xFF, // invalid 0b10100100
-    0x03, // 0xA5    0b10100101
-    0x05, // 0xA6    0b10100110
-    0xFF, // invalid 0b10100111
-    0xFF, // invalid 0b10101000
-    0x02, // 0xA9    0b10101001
-    0x01, // 0xAA    0b10101010
-    0xFF, // invalid 0b10101011
-    0x00, // 0xAC    0b10101100
-    0xFF, // invalid 0b10101101
-    0xFF, // invalid 0b10101110
-    0xFF, // invalid 0b10101111
-    0xFF, // invalid 0b10110000
-    0x0F, // 0xB1    0b10110001
-    0x10, // 0xB2    0b10110010
-    0xFF, // invalid 0b10110011
-    0x11, // 0xB4    0b10110100
-    0xFF, // invalid 0b10110101
-    0xFF, // invalid 0b10110110
-    0xFF, // invalid 0b10110111
-    0x12, // 0xB8    0b10111000
-    0xFF, // invalid 0b10111001
-    0xFF, // invalid 0b10111010
-    0xFF, // invalid 0b10111011
-    0xFF, // invalid 0b10111100
-    0xFF, // invalid 0b10111101
-    0xFF, // invalid 0b10111110
-    0xFF, // invalid 0b10111111
-    0xFF, // invalid 0b11000000
-    0xFF, // invalid 0b11000001
-    0xFF, // invalid 0b11000010
-    0xEE, // not use 0b11000011
-    0xFF, // invalid 0b11000100
-    0x2B, // 0xC5    0b11000101
-    0x30, // 0xC6    0b11000110
-    0xFF, // invalid 0b11000111
-    0xFF, // invalid 0b11001000
-    0x2A, // 0xC9    0b11001001
-    0x2F, // 0xCA    0b11001010
-    0xFF, // invalid 0b11001011
-    0x31, // 0xCC    0b11001100
-    0xFF, // invalid 0b11001101
-    0xFF, // invalid 0b11001110
-    0xFF, // invalid 0b11001111
-    0xFF, // invalid 0b11010000
-    0x29, // 0xD1    0b11010001
-    0x2E, // 0xD2    0b11010010
-    0xFF, // invalid 0b11010011
-    0x2D, // 0xD4    0b11010100
-    0xFF, // invalid 0b11010101
-    0xFF, // invalid 0b11010110
-    0xFF, // invalid 0b11010111
-    0x2C, // 0xD8    0b11011000
-    0xFF, // invalid 0b11011001
-    0xFF, // invalid 0b11011010
-    0xFF, // invalid 0b11011011
-    0xFF, // invalid 0b11011100
-    0xFF, // invalid 0b11011101
-    0xFF, // invalid 0b11011110
-    0xFF, // invalid 0b11011111
-    0xFF, // invalid 0b11100000
-    0x42, // BUSY    0b11100001
-    0x28, // 0xE2    0b11100010
-    0xFF, // invalid 0b11100011
-    0x27, // 0xE4    0b11100100
-    0xFF, // invalid 0b11100101
-    0xFF, // invalid 0b11100110
-    0xFF, // invalid 0b11100111
-    0x26, // 0xE8    0b11101000
-    0xFF, // invalid 0b11101001
-    0xFF, // invalid 0b11101010
-    0xFF, // invalid 0b11101011
-    0xFF, // invalid 0b11101100
-    0xFF, // invalid 0b11101101
-    0xFF, // invalid 0b11101110
-    0x41, // ACK     0b11110000
-    0xFF, // invalid 0b11110001
-    0xFF, // invalid 0b11110010
-    0xFF, // invalid 0b11110011
-    0xFF, // invalid 0b11110100
-    0xFF, // invalid 0b11110101
-    0xFF, // invalid 0b11110110
-    0xFF, // invalid 0b11110111
-    0xFF, // invalid 0b11111000
-    0xFF, // invalid 0b11111001
-    0xFF, // invalid 0b11111010
-    0xFF, // invalid 0b11111011
-    0xFF, // invalid 0b11111100
-    0xFF, // invalid 0b11111101
-    0xFF, // invalid 0b11111110
-    0xFF, // invalid 0b11111111
-};
\ No newline at end of file
+// ids of mobile decoders in channel 2
+const std::array<RailcomDecoder::Channel2Format, 16> RailcomDecoder::channel2Formats = {{
+    {2, Channel2Type::ePom, 0x20},     // 0 POM
+    {2, Channel2Type::eAdr, 0},        // 1 ADR high
+    {2, Channel2Type::eAdr, 0},        // 2 ADR low
+    {3, Channel2Type::eExt, 0x21},     // 3 EXT
+    {0, Channel2Type::eUnknown, 0},    // 4
+    {0, Channel2Type::eUnknown, 0},    // 5
+    {0, Channel2Type::eUnknown, 0},    // 6
+    {3, Channel2Type::eDyn, 0x22},     // 7 DYN
+#ifdef RAILCOM_TIMER_TRIGGER
+    {6, Channel2Type::eXpom, 0x23},    // 8 XPOM 0
+    {6, Channel2Type::eXpom, 0x23},    // 9 XPOM 1
+    {6, Channel2Type::eXpom, 0x23},    // 10 XPOM 2
+    {6, Channel2Type::eXpom, 0x23},    // 11 XPOM 3
+#else
+    // symbols of XPOM are skipped, but not forwarded
+    {6, Channel2Type::eXpom, 0},       // 8 XPOM 0
+    {6, Channel2Type::eXpom, 0},       // 9 XPOM 1
+    {6, Channel2Type::eXpom, 0},       // 10 XPOM 2
+    {6, Channel2Type::eXpom, 0},       // 11 XPOM 3
+#endif
+    {6, Channel2Type::eCvAuto, 0},     // 12 CV-auto
+    {0, Channel2Type::eUnknown, 0},    // 13
+    {0, Channel2Type::eUnknown, 0},    // 14
+    {0, Channel2Type::eUnknown, 0},    // 15
+}};
+
+// ids of accessory decoders in channel 2, only status and error reports are forwarded
+const std::array<RailcomDecoder::Channel2Format, 16> RailcomDecoder::accessoryChannel2Formats = {{
+    {2, Channel2Type::ePom, 0},        // 0 POM
+    {0, Channel2Type::eUnknown, 0},    // 1
+    {0, Channel2Type::eUnknown, 0},    // 2
+    {2, Channel2Type::eStat4, 0x30},   // 3 STAT4 state of 4 output pairs
+    {2, Channel2Type::eStat1, 0x31},   // 4 STAT1 state of decoder
+    {2, Channel2Type::eTime, 0x32},    // 5 TIME remaining switching time
+    {2, Channel2Type::eError, 0x33},   // 6 ERROR
+    {3, Channel2Type::eDyn, 0},        // 7 DYN
+    {6, Channel2Type::eXpom, 0},       // 8 XPOM 0
+    {6, Channel2Type::eXpom, 0},       // 9 XPOM 1
+    {6, Channel2Type::eXpom, 0},       // 10 XPOM 2
+    {6, Channel2Type::eXpom, 0},       // 11 XPOM 3
+    {0, Channel2Type::eUnknown, 0},    // 12
+    {0, Channel2Type::eUnknown, 0},    // 13
+    {0, Channel2Type::eUnknown, 0},    // 14
+    {0, Channel2Type::eUnknown, 0},    // 15
+}};
+
+// dyn values of mobile decoders which are pushed on change
+const std::array<RailcomDecoder::TelemetryFormat, RailcomDecoder::numberOfTelemetryValues> RailcomDecoder::telemetryFormats = {{
+    {0, 0x25, 2, 100, 1000},     // speed in km/h, subindex 1 is added
+    {7, 0x26, 5, 1000, 5000},    // qos in percent of faulty packets
+    {26, 0x27, 2, 5000, 30000},  // temperature
+    {8, 0x28, 5, 5000, 30000},   // level of container 1
+    {9, 0x28, 5, 5000, 30000},   // level of container 2
+    {10, 0x28, 5, 5000, 30000},  // level of container 3
+    {11, 0x28, 5, 5000, 30000},  // level of container 4
+}};
@@ -25,6 +25,7 @@
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc1;
+ADC_HandleTypeDef hadc2;
 DMA_HandleTypeDef hdma_adc1;
 
 /* ADC1 init function */
@@ -69,6 +70,25 @@ void MX_ADC1_Init(void)
   /* USER CODE END ADC1_Init 2 */
 }
 
+/* ADC2 init function */
+void MX_ADC2_Init(void)
+{
+  /** Common config
+   * ADC2 is only used as slave of ADC1 in dual mode
+   */
+  hadc2.Instance = ADC2;
+  hadc2.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc2.Init.ContinuousConvMode = ENABLE;
+  hadc2.Init.DiscontinuousConvMode = DISABLE;
+  hadc2.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc2.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc2.Init.NbrOfConversion = 1;
+  if (HAL_ADC_Init(&hadc2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
 void HAL_ADC_MspInit(ADC_HandleTypeDef *adcHandle)
 {
 
@@ -114,9 +134,17 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef *adcHandle)
     __HAL_LINKDMA(adcHandle, DMA_Handle, hdma_adc1);
 
     /* USER CODE BEGIN ADC1_MspInit 1 */
+    /* ADC1 interrupt is only used by analog watchdog */
+    HAL_NVIC_SetPriority(ADC1_2_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
 
     /* USER CODE END ADC1_MspInit 1 */
   }
+  else if (adcHandle->Instance == ADC2)
+  {
+    /* ADC2 clock enable, pins are configured by ADC1 */
+    __HAL_RCC_ADC2_CLK_ENABLE();
+  }
 }
 
 void HAL_ADC_MspDeInit(ADC_HandleTypeDef *adcHandle)
@@ -145,9 +173,14 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef *adcHandle)
     /* ADC1 DMA DeInit */
     HAL_DMA_DeInit(adcHandle->DMA_Handle);
     /* USER CODE BEGIN ADC1_MspDeInit 1 */
+    HAL_NVIC_DisableIRQ(ADC1_2_IRQn);
 
     /* USER CODE END ADC1_MspDeInit 1 */
   }
+  else if (adcHandle->Instance == ADC2)
+  {
+    __HAL_RCC_ADC2_CLK_DISABLE();
+  }
 }
 
 void DMA1_Channel1_IRQHandler(void)
@@ -155,6 +188,12 @@ void DMA1_Channel1_IRQHandler(void)
   HAL_DMA_IRQHandler(&hdma_adc1);
 }
 
+void ADC1_2_IRQHandler(void)
+{
+  HAL_ADC_IRQHandler(&hadc1);
+  HAL_ADC_IRQHandler(&hadc2);
+}
+
 /* USER CODE BEGIN 1 */
 void configSingleMeasurementMode()
 {
@@ -188,14 +227,159 @@ void configContinuousDmaMode()
 }
 
 void setChannel(int pin)
+{
+  setScanChannels(&pin, 1);
+}
+
+void setScanChannels(const int *pins, uint32_t numberOfChannels)
+{
+  setScanChannelsSamplingTime(pins, numberOfChannels, ADC_SAMPLETIME_1CYCLE_5);
+}
+
+void setScanChannelsSamplingTime(const int *pins, uint32_t numberOfChannels, uint32_t samplingTime)
+{
+  ADC_ChannelConfTypeDef sConfig = {0};
+  for (uint32_t i = 0; i < numberOfChannels; i++)
+  {
+    sConfig.Channel = channel[pins[i] - PA0];
+    sConfig.Rank = ADC_REGULAR_RANK_1 + i;
+    sConfig.SamplingTime = samplingTime;
+    if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
+  // switch scan mode without complete init of adc
+  hadc1.Init.ScanConvMode = (numberOfChannels > 1) ? ADC_SCAN_ENABLE : ADC_SCAN_DISABLE;
+  hadc1.Init.NbrOfConversion = numberOfChannels;
+  MODIFY_REG(hadc1.Instance->CR1, ADC_CR1_SCAN, (numberOfChannels > 1) ? ADC_CR1_SCAN : 0);
+  MODIFY_REG(hadc1.Instance->SQR1, ADC_SQR1_L, (numberOfChannels - 1) << ADC_SQR1_L_Pos);
+}
+
+void setExternalTrigger(uint32_t externalTrigConv)
+{
+  hadc1.Init.ExternalTrigConv = externalTrigConv;
+  MODIFY_REG(hadc1.Instance->CR2, ADC_CR2_EXTSEL, externalTrigConv);
+}
+
+static void configDmaDataAlignment(uint32_t periphDataAlignment, uint32_t memDataAlignment)
+{
+  hdma_adc1.Init.PeriphDataAlignment = periphDataAlignment;
+  hdma_adc1.Init.MemDataAlignment = memDataAlignment;
+  if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+static void configMultiMode(uint32_t mode)
+{
+  ADC_MultiModeTypeDef multimode = {0};
+  // mode can only be changed while both adcs are disabled
+  HAL_ADC_Stop(&hadc1);
+  HAL_ADC_Stop(&hadc2);
+  multimode.Mode = mode;
+  if (HAL_ADCEx_MultiModeConfigChannel(&hadc1, &multimode) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+void configDualMode()
+{
+  configMultiMode(ADC_DUALMODE_REGSIMULT);
+  // result of ADC2 is in upper half word of ADC1 data register
+  configDmaDataAlignment(DMA_PDATAALIGN_WORD, DMA_MDATAALIGN_WORD);
+}
+
+void setDualChannels(int pin1, int pin2)
 {
   ADC_ChannelConfTypeDef sConfig = {0};
-  sConfig.Channel = channel[pin - PA0];
+  setChannel(pin1);
+  sConfig.Channel = channel[pin2 - PA0];
   sConfig.Rank = ADC_REGULAR_RANK_1;
   sConfig.SamplingTime = ADC_SAMPLETIME_1CYCLE_5;
-  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  if (HAL_ADC_ConfigChannel(&hadc2, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+void setDmaMode(uint32_t mode)
+{
+  // mode is kept by start of dma, so no complete init of dma is needed
+  hdma_adc1.Init.Mode = mode;
+  MODIFY_REG(hdma_adc1.Instance->CCR, DMA_CCR_CIRC, mode);
+}
+
+void disableDmaTransferInterrupts()
+{
+  __HAL_DMA_DISABLE_IT(&hdma_adc1, DMA_IT_TC | DMA_IT_HT);
+}
+
+void enableAnalogWatchdog(uint16_t lowThreshold, uint16_t highThreshold)
+{
+  ADC_AnalogWDGConfTypeDef analogWDGConfig = {0};
+  analogWDGConfig.WatchdogMode = ADC_ANALOGWATCHDOG_ALL_REG;
+  analogWDGConfig.HighThreshold = highThreshold;
+  analogWDGConfig.LowThreshold = lowThreshold;
+  analogWDGConfig.ITMode = ENABLE;
+  // old event must not trigger interrupt at once
+  __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD);
+  if (HAL_ADC_AnalogWDGConfig(&hadc1, &analogWDGConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+void disableAnalogWatchdog()
+{
+  __HAL_ADC_DISABLE_IT(&hadc1, ADC_IT_AWD);
+  CLEAR_BIT(hadc1.Instance->CR1, ADC_CR1_AWDEN);
+  __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD);
+}
+
+void configInjectedChannels(const int *pins, uint32_t numberOfPins, uint32_t samplingTime)
+{
+  ADC_InjectionConfTypeDef sConfigInjected = {0};
+  // pins are configured backwards, so that first 4 pins are left in sequence
+  for (uint32_t i = numberOfPins; i > 0; i--)
+  {
+    sConfigInjected.InjectedChannel = channel[pins[i - 1] - PA0];
+    sConfigInjected.InjectedRank = ADC_INJECTED_RANK_1 + ((i - 1) % 4);
+    sConfigInjected.InjectedSamplingTime = samplingTime;
+    sConfigInjected.InjectedOffset = 0;
+    sConfigInjected.InjectedNbrOfConversion = 4;
+    sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+    sConfigInjected.AutoInjectedConv = DISABLE;
+    sConfigInjected.ExternalTrigInjecConv = ADC_EXTERNALTRIGINJECCONV_T4_TRGO;
+    if (HAL_ADCEx_InjectedConfigChannel(&hadc2, &sConfigInjected) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
+  // injected sequence of several channels needs scan mode
+  SET_BIT(hadc2.Instance->CR1, ADC_CR1_SCAN);
+}
+
+void setInjectedChannels(const int *pins)
+{
+  // called in interrupt, so sequence is written directly, sampling time is already set
+  hadc2.Instance->JSQR = (3 << ADC_JSQR_JL_Pos) |
+                         (channel[pins[0] - PA0] << ADC_JSQR_JSQ1_Pos) | (channel[pins[1] - PA0] << ADC_JSQR_JSQ2_Pos) |
+                         (channel[pins[2] - PA0] << ADC_JSQR_JSQ3_Pos) | (channel[pins[3] - PA0] << ADC_JSQR_JSQ4_Pos);
+}
+
+void startInjectedConversion()
+{
+  if (HAL_ADCEx_InjectedStart_IT(&hadc2) != HAL_OK)
   {
     Error_Handler();
   }
 }
+
+uint16_t getInjectedValue(uint32_t rank)
+{
+  return HAL_ADCEx_InjectedGetValue(&hadc2, ADC_INJECTED_RANK_1 + rank);
+}
 /* USER CODE END 1 */
@@ -0,0 +1,188 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    tim.c
+  * @brief   This file provides code for the configuration
+  *          of the TIM instances.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Includes ------------------------------------------------------------------*/
+#include "Stm32f1/tim.h"
+
+/* USER CODE BEGIN 0 */
+
+/* USER CODE END 0 */
+
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim4;
+
+/* TIM1 init function */
+void MX_TIM1_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_IC_InitTypeDef sConfigIC = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  /** 1 MHz free running counter, TIM1 is clocked with 56 MHz from APB2
+   */
+  htim1.Instance = TIM1;
+  htim1.Init.Prescaler = 55;
+  htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim1.Init.Period = 0xFFFF;
+  htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim1.Init.RepetitionCounter = 0;
+  htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim1, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_IC_Init(&htim1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_OC_Init(&htim1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Channel 1 captures rising and channel 2 falling edges of dcc signal on PA8 (TI1)
+   */
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+  sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+  sConfigIC.ICFilter = 0;
+  if (HAL_TIM_IC_ConfigChannel(&htim1, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_FALLING;
+  sConfigIC.ICSelection = TIM_ICSELECTION_INDIRECTTI;
+  if (HAL_TIM_IC_ConfigChannel(&htim1, &sConfigIC, TIM_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Compare event of channel 3 is the regular trigger of ADC1, PA10 is not switched to timer output
+   */
+  sConfigOC.OCMode = TIM_OCMODE_TIMING;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
+  if (HAL_TIM_OC_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  HAL_TIM_Base_Start(&htim1);
+  HAL_TIM_IC_Start(&htim1, TIM_CHANNEL_1);
+  HAL_TIM_IC_Start(&htim1, TIM_CHANNEL_2);
+  HAL_TIM_OC_Start(&htim1, TIM_CHANNEL_3);
+}
+
+/* TIM4 init function */
+void MX_TIM4_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /** 1 MHz counter, TIM4 is clocked with 56 MHz from twice APB1, period is set by startInjectedTrigger
+   */
+  htim4.Instance = TIM4;
+  htim4.Init.Prescaler = 55;
+  htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim4.Init.Period = 0xFFFF;
+  htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Update event is TRGO, the injected trigger of ADC2, no pin is used
+   */
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *tim_baseHandle)
+{
+  if (tim_baseHandle->Instance == TIM1)
+  {
+    /* TIM1 clock enable, PA8 is already input of dcc signal */
+    __HAL_RCC_TIM1_CLK_ENABLE();
+  }
+  else if (tim_baseHandle->Instance == TIM4)
+  {
+    __HAL_RCC_TIM4_CLK_ENABLE();
+  }
+}
+
+void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef *tim_baseHandle)
+{
+  if (tim_baseHandle->Instance == TIM1)
+  {
+    __HAL_RCC_TIM1_CLK_DISABLE();
+  }
+  else if (tim_baseHandle->Instance == TIM4)
+  {
+    __HAL_RCC_TIM4_CLK_DISABLE();
+  }
+}
+
+/* USER CODE BEGIN 1 */
+void holdAdcTrigger(void)
+{
+  // counter reaches a compare value just behind it only after a full period of 65.5ms
+  TIM1->CCR3 = (uint16_t)(TIM1->CNT - 1);
+  CLEAR_BIT(TIM1->SR, TIM_SR_CC3IF);
+}
+
+bool armAdcTrigger(uint16_t delayINus)
+{
+  uint16_t now = TIM1->CNT;
+  uint16_t sinceRisingEdge = now - TIM1->CCR1;
+  uint16_t sinceFallingEdge = now - TIM1->CCR2;
+  uint16_t elapsed = (sinceRisingEdge < sinceFallingEdge) ? sinceRisingEdge : sinceFallingEdge;
+  // keep 2us for writing compare value
+  if ((elapsed + 2) < delayINus)
+  {
+    TIM1->CCR3 = (uint16_t)(now - elapsed + delayINus);
+    return true;
+  }
+  // compare event generated by software starts conversion at once
+  TIM1->EGR = TIM_EGR_CC3G;
+  return false;
+}
+
+void startInjectedTrigger(uint16_t periodINus)
+{
+  __HAL_TIM_SET_AUTORELOAD(&htim4, periodINus - 1);
+  HAL_TIM_Base_Start(&htim4);
+}
+/* USER CODE END 1 */
@@ -611,6 +611,20 @@ bool ZCanInterface::requestModulePowerInfo(uint16_t id)
     return sendMessage(message);
 }
 
+bool ZCanInterface::sendModulePowerInfoEvt(uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA)
+{
+    ZCanMessage message;
+    messageModulePowerInfoEvt(message, port, status, voltageINmV, currentINmA);
+    return sendMessage(message);
+}
+
+bool ZCanInterface::sendModulePowerInfoAck(uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA)
+{
+    ZCanMessage message;
+    messageModulePowerInfoAck(message, port, status, voltageINmV, currentINmA);
+    return sendMessage(message);
+}
+
 bool ZCanInterface::requestModuleInfo(uint16_t id, uint16_t type)
 {
     ZCanMessage message;
@@ -855,6 +869,42 @@ void ZCanInterface::messageRequestModulePowerInfo(ZCanMessage &message, uint16_t
     message.data[1] = 0xFF & (id >> 8);
 }
 
+void ZCanInterface::messageModulePowerInfoEvt(ZCanMessage &message, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA)
+{
+    message.clear();
+    message.group = static_cast<uint8_t>(Group::Info);
+    message.command = static_cast<uint8_t>(InfoCmd::ModulPowerInfo);
+    message.mode = static_cast<uint8_t>(Mode::Evt);
+    message.networkId = m_networkId;
+    message.length = 0x08;
+    message.data[0] = port;
+    message.data[1] = 0x00;
+    message.data[2] = 0xFF & status;
+    message.data[3] = 0xFF & (status >> 8);
+    message.data[4] = 0xFF & voltageINmV;
+    message.data[5] = 0xFF & (voltageINmV >> 8);
+    message.data[6] = 0xFF & currentINmA;
+    message.data[7] = 0xFF & (currentINmA >> 8);
+}
+
+void ZCanInterface::messageModulePowerInfoAck(ZCanMessage &message, uint8_t port, uint16_t status, uint16_t voltageINmV, uint16_t currentINmA)
+{
+    message.clear();
+    message.group = static_cast<uint8_t>(Group::Info);
+    message.command = static_cast<uint8_t>(InfoCmd::ModulPowerInfo);
+    message.mode = static_cast<uint8_t>(Mode::Ack);
+    message.networkId = m_networkId;
+    message.length = 0x08;
+    message.data[0] = port;
+    message.data[1] = 0x00;
+    message.data[2] = 0xFF & status;
+    message.data[3] = 0xFF & (status >> 8);
+    message.data[4] = 0xFF & voltageINmV;
+    message.data[5] = 0xFF & (voltageINmV >> 8);
+    message.data[6] = 0xFF & currentINmA;
+    message.data[7] = 0xFF & (currentINmA >> 8);
+}
+
 void ZCanInterface::messageRequestModuleInfo(ZCanMessage &message, uint16_t id, uint16_t type)
 {
     message.clear();
@@ -26,10 +26,12 @@
 #include "Helper/xprintf.h"
 #include "NmraDcc.h"
 #include "Stm32f1/Flash.h"
+#include <cstring>
 #include <vector>
 #include <memory>
 #include "Stm32f1/adc.h"
 #include "Stm32f1/dma.h"
+#include "Stm32f1/tim.h"
 
 #define FUNCTIONDECODER
 
@@ -45,8 +47,21 @@ typedef struct
   FeedbackDecoder::ModulConfig modulConfig1;
   FeedbackDecoder::ModulConfig modulConfig2;
   FunctionDecoder<8>::Config functionDecoderConfig;
+  // new data is appended, so that memory of older firmware keeps its offsets
+  FeedbackDecoder::PowerInfoConfig powerInfoConfig1;
+  FeedbackDecoder::PowerInfoConfig powerInfoConfig2;
 } MemoryData;
 
+// layout of memory before ModulConfig got trackConfigVersion
+typedef struct
+{
+  FeedbackDecoder::LegacyModulConfig modulConfig1;
+  FeedbackDecoder::LegacyModulConfig modulConfig2;
+  FunctionDecoder<8>::Config functionDecoderConfig;
+} LegacyMemoryData;
+
+static_assert(sizeof(LegacyMemoryData) <= sizeof(MemoryData), "legacy memory is read as part of memoryData");
+
 MemoryData memoryData;
 
 int statusClkPin{PB0};
@@ -65,7 +80,7 @@ int configRailcomPin{PB12};
 int configIdPin1{PB13};
 
 // I will need in the end two of those moduls to handle each of the 8 inputs
-RailcomDecoderStm32f1 railcomDecoder(memoryData.modulConfig1, Flash::writeData, trackPin1,
+RailcomDecoderStm32f1 railcomDecoder(memoryData.modulConfig1, memoryData.powerInfoConfig1, Flash::writeData, trackPin1,
                                      configRailcomPin, configIdPin1, statusLed.getStatusArray()[0], xprintf, true, false, true);
 
 std::array<int, 8> trackPin2{PB9, PB8, PB7, PB6, PB5, PB4, PB3, PA15};
@@ -75,7 +90,7 @@ int configIdPin2{PB14};
 FunctionDecoder<8> functionDecoder(memoryData.functionDecoderConfig, Flash::writeData, trackPin2, configIdPin2, xprintf, true);
 #else
 // I will need in the end two of those moduls to handle each of the 8 inputs
-FeedbackDecoder feedbackDecoder2(memoryData.modulConfig2, Flash::writeData, trackPin2,
+FeedbackDecoder feedbackDecoder2(memoryData.modulConfig2, memoryData.powerInfoConfig2, Flash::writeData, trackPin2,
                                  configRailcomPin, configIdPin2, statusLed.getStatusArray()[1], xprintf, true, false, false);
 #endif
 
@@ -90,6 +105,24 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
   railcomDecoder.callbackAdcReadFinished(hadc);
 }
 
+// Called when first half of buffer is filled
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  railcomDecoder.callbackAdcReadHalfFinished(hadc);
+}
+
+// Called when a converted value is outside of analog watchdog window
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+  railcomDecoder.callbackAdcWatchdog(hadc);
+}
+
+// Called when injected sequence is converted
+void HAL_ADCEx_InjectedConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  railcomDecoder.callbackAdcInjectedFinished(hadc);
+}
+
 static void ThreadCyclic(void *arg);
 static void ThreadLedBlink(void *arg);
 
@@ -104,9 +137,17 @@ void setup()
   xdev_out(uart_putc);
   MX_DMA_Init();
   MX_ADC1_Init();
+  MX_ADC2_Init();
   Serial.printf("ZCAN Feedback Decoder system frequency: %lu\n", HAL_RCC_GetSysClockFreq());
   // Calibrate The ADC On Power-Up For Better Accuracy
   HAL_ADCEx_Calibration_Start(&hadc1);
+  HAL_ADCEx_Calibration_Start(&hadc2);
+#ifdef RAILCOM_TIMER_TRIGGER
+  MX_TIM1_Init();
+#endif
+#ifdef OCCUPANCY_INJECTED_MODE
+  MX_TIM4_Init();
+#endif
 
 
   if (pdPASS != xTaskCreate(ThreadLedBlink, nullptr, 256, nullptr, 0, nullptr))
@@ -146,6 +187,25 @@ void setup()
   Flash::m_memoryDataPtr = (uint16_t *)&memoryData;
   Flash::m_memoryDataSize = sizeof(MemoryData);
   Flash::readData();
+  if (FeedbackDecoder::isLegacyModulConfig(memoryData.modulConfig1))
+  {
+    // every field behind sendChannel2Data of modulConfig1 moved, so modulConfig2 and functionDecoderConfig moved as well
+    LegacyMemoryData legacyData;
+    memcpy(&legacyData, &memoryData, sizeof(LegacyMemoryData));
+    if (FeedbackDecoder::isValidLegacyModulConfig(legacyData.modulConfig1) && FeedbackDecoder::isValidLegacyModulConfig(legacyData.modulConfig2))
+    {
+      FeedbackDecoder::migrateModulConfig(legacyData.modulConfig1, memoryData.modulConfig1);
+      FeedbackDecoder::migrateModulConfig(legacyData.modulConfig2, memoryData.modulConfig2);
+      memoryData.functionDecoderConfig = legacyData.functionDecoderConfig;
+      Flash::writeData();
+      xprintf("Memory of legacy layout migrated\n");
+    }
+    else
+    {
+      // flash is not rewritten, begin() sets default values of track config
+      xprintf("Memory of unknown layout not migrated\n");
+    }
+  }
 
   railcomDecoder.begin();
 #ifdef FUNCTIONDECODER
@@ -307,7 +367,14 @@ extern "C" void SystemClock_Config(void)
     Error_Handler();
   }
   PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_ADC;
+#ifdef RAILCOM_DECIMATION_MODE
+  // 1.5 cycles sampling and 12.5 cycles conversion at 7 MHz are one sample each 2us
+  // current sense keeps 6us per conversion of scan and injected group by a shorter sampling time, see RailcomDecoderStm32f1
+  // single port current sense takes 256us instead of 128us for its 128 samples
+  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV8;
+#else
   PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV4;
+#endif
   if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
   {
     Error_Handler();